@@ -7,11 +7,37 @@
  * @note Using string_to_number, because it use -1 as error
  */
 
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <ctype.h>
 #include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <string.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <limits.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <sys/uio.h>
+#include <elf.h>
+#include <dirent.h>
+#include <sys/sendfile.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#endif
 
 //#define NDEBUG
 
@@ -56,13 +82,26 @@ static unsigned int _failed_tests = 0;
 #endif
 
 typedef unsigned int uint32;
+typedef unsigned short uint16;
 typedef unsigned char uint8;
+typedef unsigned long long uint64;
+typedef long long int64;
 
 // *********DECLARATION OF TESTS*********
 void test_math_api();
 void test_string_api();
 void test_hex_api();
 void test_flag_api();
+void test_split_api();
+void test_checksum_api();
+void test_throttle_api();
+void test_word_api();
+void test_sample_api();
+void test_scan_api();
+void test_dump_api();
+void test_process_api();
+void test_elf_api();
+void test_cache_api();
 
 // *********DECLARATION OF MATH API*********
 /**
@@ -119,10 +158,10 @@ bool string_is_number(const char* str);
 /**
  * @brief string_to_number Convert string into number, work only with positive numbers
  * @param str String which will be converted into number
- * @return Number, if fail return -1
+ * @return Number, if fail or number does not fit into int64 return -1
  */
 // NOTE work only with positive numbers
-int string_to_number(const char* str);
+int64 string_to_number(const char* str);
 
 /**
  * @brief string_fill Fill string with fill, string must be initialized
@@ -133,7 +172,7 @@ int string_to_number(const char* str);
 char* string_fill(char fill, char* str);
 
 /**
- * @brief nprintf Print to stdout n-times character c
+ * @brief nprintf Print to current output n-times character c
  * @param c Character, which will be printed
  * @param count Number of printed characters
  */
@@ -151,6 +190,20 @@ typedef struct
  */
 void hex_null(Hex8* h);
 
+typedef enum
+{
+    HEX_SPACE = 16,     // 0 - 15 are values of hex digits
+    HEX_INVALID = 17
+} HexClass;
+
+/**
+ * @brief hex_classify Return value of hex digit c, HEX_SPACE if c is
+ * whitespace and HEX_INVALID otherwise
+ * @param c Character which will be classified
+ * @return 0 - 15 or HexClass
+ */
+uint8 hex_classify(int c);
+
 // *********DECLARATION OF FLAG API*********
 typedef enum
 {
@@ -160,14 +213,38 @@ typedef enum
     NUMBER_OF_CHARS = 2,
     UNFORMATED_HEX = 4,
     SPLIT = 8,
-    REVERSE = 16
+    REVERSE = 16,
+    THREADS = 32,
+    OFFSETS = 64,
+    UTF16 = 128,
+    DAEMON = 256,
+    CLIENT = 512,
+    CHECKSUM = 1024,
+    XXHASH = 2048,
+    INPUT_RATE = 4096,
+    OUTPUT_RATE = 8192,
+    BACKGROUND_IO = 16384,
+    TYPED = 32768,
+    DIRECT_IO = 65536,
+    SAMPLE_EVERY = 131072,
+    SAMPLE_RANDOM = 262144,
+    SAMPLE_SEED = 524288,
+    SCAN = 1048576,
+    SCAN_FILE = 2097152,
+    SCAN_CONTEXT = 4194304,
+    DUMP_FILE = 8388608,
+    PROCESS = 16777216,
+    PROCESS_RANGE = 33554432,
+    ELF_TARGET = 67108864,
+    CACHE = 134217728,
+    CACHE_LIMIT = 268435456
 } Actions;
 
 // SETTINGS OF FLAGS
 const unsigned int split_minimum_word_len = 0;
 const unsigned int split_maximum_word_len = 200;
-// NOTE '%' means optional number param '&' means required param
-static const char* STR_FLAGS[] = {"-s&", "-n&", "-x", "-S&", "-r"}; // '%' means expect unsigned int
+// NOTE '%' means optional number param '&' means required param '$' means required string param
+static const char* STR_FLAGS[] = {"-s&", "-n&", "-x", "-S&", "-r", "-j&", "-o", "-u", "-D$", "-C$", "-c%", "-H", "-R&", "-W&", "-F", "-t$", "-d", "-e&", "-k&", "-z&", "-M", "-m$", "-w&", "-O$", "-p&", "-A$", "-E$", "-P$", "-L&"}; // '%' means expect unsigned int
 static const int FLAGS_COUNT = sizeof(STR_FLAGS) / sizeof(char*);
 
 typedef enum
@@ -186,11 +263,12 @@ typedef enum
  * @param argc Arguments count
  * @param argv Arguments with flags and parameters
  * @param flags_parameters All flags parameters are stored in it,
- * it must have size of 16 elements == max flag value,
- * -1 == unexpected argument, -2 expected argument
+ * it must have FLAGS_COUNT elements, parameter of flag is at flag_index,
+ * -1 == unexpected argument, -2 expected argument,
+ * string parameters are stored as index into argv
  * @return Bit flags stored in int
  */
-unsigned int parse_arguments(int argc, const char* argv[], int* flags_parameters);
+unsigned int parse_arguments(int argc, const char* argv[], int64* flags_parameters);
 
 /**
  * @brief is_flag Test str if it is in flag format, return 1
@@ -224,6 +302,21 @@ bool flag_accept_param(Actions action);
  */
 bool flag_require_param(Actions action);
 
+/**
+ * @brief flag_require_string If action require string param return 1
+ * else return 0
+ * @param action Action which will be tested
+ * @return 1 or 0 <=> true or false
+ */
+bool flag_require_string(Actions action);
+
+/**
+ * @brief flag_index Return index of action in STR_FLAGS
+ * @param action Action, must not be UNDEFINED
+ * @return Index of flag
+ */
+int flag_index(Actions action);
+
 /**
  * @brief flags_validation Takes argc and argv and check all invalid flags and parameters
  * @param argc
@@ -239,492 +332,5267 @@ Errors flags_validation(int argc, const char *argv[]);
  */
 bool flag_is_allowed(const char* str_flag);
 
-// *********DECLARATION OF ACTION API*********
+// *********DECLARATION OF IO API*********
+typedef struct
+{
+    FILE* in;
+    FILE* out;
+    FILE* err;
+    int in_fd;      // descriptor behind in, -1 if in is not backed by descriptor
+    int out_fd;     // descriptor behind out, -1 if out is not backed by descriptor
+    off_t in_size;  // size of seekable input without descriptor, -1 if unknown
+} IoContext;
+
 /**
- * @brief action_unformated_hex Takes str from stdin and print it as hex
+ * @brief io_context Return streams of current thread, by default
+ * stdin, stdout and stderr
+ * @return Current context
  */
-void action_unformated_hex();
+IoContext* io_context();
 
 /**
- * @brief action_reverse Convert hex str from stdin to str, ignor whitespace etc.
+ * @brief io_set_context Set streams used by actions in current thread
+ * @param io Context, NULL means standard streams
  */
-void action_reverse();
+void io_set_context(IoContext* io);
 
 /**
- * @brief action_split Split string from stdin to "words", split by \n, \0 etc.
- * @param word_size Word must be at least >= count
+ * @brief io_getc Read one character from current input
+ * @return Character or EOF
  */
-void action_split(unsigned int word_size);
+int io_getc();
 
 /**
- * @brief action_default Printf address character in hex, 16 chars per line
- * @param address Define how many skip chars
- * @param count If count == -1, then ignore count
+ * @brief io_skip Skip n characters of current input, seekable input is not read
+ * @param n
+ * @return 0 if input ended before n characters were skipped, 1 otherwise
  */
-void action_default(uint32 address, int count);
+bool io_skip(uint64 n);
 
 /**
- * @brief print_help Print allowed combinations of flags
+ * @brief io_printf Formatted print to current output
+ * @param format
  */
-void print_help();
+void io_printf(const char* format, ...);
 
 /**
- * @brief print_error Print specific error
- * @param err
+ * @brief io_write Write len bytes of buffer to current output
+ * @param buffer
+ * @param len
  */
-void print_error(Errors err);
+void io_write(const void* buffer, uint64 len);
 
 /**
- * @brief run_actions Run specific actions according to flags
- * @param flags
- * @param params Number parameters of flags
- * @return 0 if successfull otherwise 1
+ * @brief io_error Formatted print to current error output
+ * @param format
  */
-int run_actions(int flags, int* params);
+void io_error(const char* format, ...);
 
-// NOTE Main
-int main(int argc, const char *argv[])
+// *********DECLARATION OF THROTTLE API*********
+typedef struct
 {
-#ifdef NDEBUG
-    test_math_api();
-    test_string_api();
-    test_hex_api();
-    test_flag_api();
-    TST_TOTAL();
-#endif
+    uint64 rate;            // bytes per second, 0 = unlimited
+    double burst;           // maximum of saved tokens
+    double tokens;          // can be negative, then caller must wait
+    struct timespec last;
+} TokenBucket;
 
-    int params[ippow(2, FLAGS_COUNT) + 1];
-    int flags = parse_arguments(argc, argv, params);
-
-    // check for unexpected  params and flags
-    Errors err = flags_validation(argc, argv);
-    print_error(err);
+typedef struct
+{
+    TokenBucket bucket;
+    FILE* file;             // wrapped stream
+    int fd;                 // descriptor of wrapped stream, -1 if there is none
+    bool drop_cache;        // posix_fadvise(DONTNEED) what was read
+    off_t position;
+    off_t dropped;          // cache is dropped up to this offset
+} ThrottledStream;
 
-    if(err != NO_ERROR) {
-        print_help();
-        return EXIT_SUCCESS;
-    }
+typedef struct
+{
+    ThrottledStream in;
+    ThrottledStream out;
+    IoContext io;           // context with wrapped streams
+    IoContext* previous;
+    int previous_ioprio;    // -1 if io priority was not changed
+} Throttle;
 
-    // run actions
-    return run_actions(flags, params);
-}
+/**
+ * @brief token_bucket_init Initialize bucket, it starts empty
+ * @param bucket
+ * @param rate Bytes per second, 0 = unlimited
+ */
+void token_bucket_init(TokenBucket* bucket, uint64 rate);
 
-// *********IMPLEMENTATION OF MATH API*********
-int ippow(int base, unsigned int exp)
-{
-    if(exp == 0)
-        return 1;
+/**
+ * @brief token_bucket_consume Take tokens for bytes, sleep if there are not enough
+ * @param bucket
+ * @param bytes
+ */
+void token_bucket_consume(TokenBucket* bucket, uint64 bytes);
 
-    int result = base;
+/**
+ * @brief token_bucket_delay Return how long caller must wait after consuming
+ * bytes at time now, tokens are taken from bucket
+ * @param bucket
+ * @param bytes
+ * @param now
+ * @return Delay in nanoseconds
+ */
+uint64 token_bucket_delay(TokenBucket* bucket, uint64 bytes, const struct timespec* now);
 
-    while(--exp)
-        result *= base;
+/**
+ * @brief throttled_read Read callback of fopencookie
+ */
+ssize_t throttled_read(void* cookie, char* buffer, size_t size);
 
-    return result;
-}
+/**
+ * @brief throttled_seek Seek callback of fopencookie, wrapped input must be seekable
+ */
+int throttled_seek(void* cookie, off64_t* offset, int whence);
 
-// *********IMPLEMENTATION OF STRING API*********
-bool string_compare(const char* str1, const char* str2)
-{
-    if(string_len(str1) != string_len(str2))
-        return false;
+/**
+ * @brief throttled_write Write callback of fopencookie
+ */
+ssize_t throttled_write(void* cookie, const char* buffer, size_t size);
 
-    while(*str1) {
-        if(*str1++ != *str2++)
-            return false;
-    }
+/**
+ * @brief throttle_begin Wrap streams of current thread so reading and writing
+ * is limited, wrapped input is not backed by descriptor, so it is not mapped,
+ * but seekable input keeps its size and can be seeked
+ * @param throttle
+ * @param input_rate Bytes per second, 0 = unlimited
+ * @param output_rate Bytes per second, 0 = unlimited
+ * @param background Drop read input from page cache and use idle io priority
+ * @return 1 or 0 <=> true or false
+ */
+bool throttle_begin(Throttle* throttle, uint64 input_rate, uint64 output_rate, bool background);
 
-    return true;
-}
+/**
+ * @brief throttle_end Flush and close wrapped streams, restore previous context
+ * @param throttle
+ */
+void throttle_end(Throttle* throttle);
 
-// NOTE return actually only number >= 0
-unsigned int string_len(const char* str)
-{
-    int size = 0;
+// *********DECLARATION OF DIRECT API*********
+#define DIRECT_BUFFERS_COUNT 4
 
-    while(*str++)
-        ++size;
+const uint64 direct_alignment = 4096;
+const uint64 direct_buffer_size = 1 << 20;
 
-    return size;
-}
+typedef struct
+{
+    uint8* data;            // aligned to direct_alignment
+    uint64 offset;          // offset of data[0] in file
+    uint64 len;
+} DirectBuffer;
 
-bool string_contain(char c, const char* str)
+typedef struct
 {
-    while(*str) {
-        if(c == *str++)
-            return true;
-    }
+    int fd;                 // opened with O_DIRECT, or fallback_fd if it was refused
+    int fallback_fd;        // buffered descriptor of the same file
+    uint64 position;        // offset of next byte returned to reader
+    uint64 read_offset;     // offset of next aligned read
+    DirectBuffer buffers[DIRECT_BUFFERS_COUNT];
+    unsigned int head;      // ring of filled buffers
+    unsigned int count;
+    bool running;
+    bool stop;
+    bool eof;
+    int error;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t filled;
+    pthread_cond_t freed;
+    IoContext io;           // context with direct input
+    IoContext* previous;
+} DirectReader;
 
-    return false;
-}
+/**
+ * @brief direct_prefetch Read ahead aligned blocks into free buffers of pool,
+ * switch to buffered reads if filesystem refuses O_DIRECT
+ * @param arg Pointer to DirectReader
+ * @return NULL
+ */
+void* direct_prefetch(void* arg);
 
-// NOTE return actually only number >= 0
-unsigned int string_count(char c, const char* str)
-{
-    int count = 0;
+/**
+ * @brief direct_read Read callback of fopencookie
+ */
+ssize_t direct_read(void* cookie, char* buffer, size_t size);
 
-    while(*str) {
-        if(c == *str++)
-            ++count;
-    }
+/**
+ * @brief direct_seek Seek callback of fopencookie, prefetching is restarted
+ */
+int direct_seek(void* cookie, off64_t* offset, int whence);
 
-    return count;
-}
+/**
+ * @brief direct_begin Replace input of current thread by reader which reads
+ * file behind input with O_DIRECT, so page cache is not used
+ * @param reader
+ * @return 0 if input is not regular file or buffers can not be allocated (then
+ * nothing is changed), 1 otherwise
+ */
+bool direct_begin(DirectReader* reader);
 
-bool string_is_number(const char* str)
+/**
+ * @brief direct_end Stop reader, restore previous context
+ * @param reader
+ */
+void direct_end(DirectReader* reader);
+
+// *********DECLARATION OF INPUT API*********
+typedef struct
 {
-    while(*str) {
-        if(!isdigit(*str))
-            return false;
-        ++str;
-    }
+    const uint8* data;
+    uint64 size;
+    uint8* mapping;      // start of mmap, NULL if data are in heap buffer
+    uint64 mapping_size;
+} InputMap;
 
-    return true;
-}
+/**
+ * @brief input_map Make whole current input accessible in memory, regular
+ * files are mapped, other inputs (pipes etc.) are read into heap buffer
+ * @param m Input map which will be filled
+ * @return 1 or 0 <=> true or false
+ */
+bool input_map(InputMap* m);
 
-int string_to_number(const char* str)
-{
-    if(!string_is_number(str))
-        return -1;
+/**
+ * @brief input_unmap Release memory acquired by input_map
+ * @param m
+ */
+void input_unmap(InputMap* m);
+
+// *********DECLARATION OF OUTPUT API*********
+/**
+ * @brief output_offset Return current offset of fd if output can be
+ * written to any position by pwrite (regular file without O_APPEND)
+ * @param fd
+ * @return Offset or -1 if fd is not seekable
+ */
+off_t output_offset(int fd);
 
-    const int str_len = string_len(str);
-    int result = 0;
+/**
+ * @brief output_write Write whole buffer to fd, retry on partial writes
+ * @param fd
+ * @param buffer
+ * @param len
+ * @param offset Position for pwrite, if offset < 0 write sequentially
+ * @return 1 or 0 <=> true or false
+ */
+bool output_write(int fd, const void* buffer, uint64 len, off_t offset);
 
-    for(int i = str_len; *str; i--)
-        result += (*str++ - '0') * ippow(10, i - 1);
+// *********DECLARATION OF THREAD API*********
+/**
+ * @brief threads_count Return number of worker threads
+ * @param requested Requested number, if <= 0 use number of online cpus
+ * @return Number of threads, at least 1
+ */
+unsigned int threads_count(int requested);
 
-    return result;
-}
+/**
+ * @brief parallel_run Call worker for every item, each in its own thread,
+ * first item is processed by calling thread, wait until all are finished
+ * @param worker
+ * @param items Array of items
+ * @param item_size Size of one item in bytes
+ * @param count Number of items
+ */
+void parallel_run(void* (*worker)(void*), void* items, size_t item_size, unsigned int count);
 
-char* string_fill(char fill, char* str)
+// *********DECLARATION OF SPLIT API*********
+typedef enum
 {
-    char *orig = str;   // because str pointer is being modified
-
-    while(*str)
-        *str++ = fill;
-    return orig;
-}
+    RUN_ASCII = 0,
+    RUN_UTF16_EVEN = 1,    // UTF-16LE units starting at even offsets
+    RUN_UTF16_ODD = 2,
+    RUN_KINDS_COUNT = 3
+} RunKind;
 
-void nprintf(char c, unsigned int count)
+typedef struct
 {
-    while(count--)
-        printf("%c", c);
-}
+    uint64 offset;
+    uint64 len;     // in characters, not in bytes
+} SplitRun;
 
-// *********IMPLEMENTATION OF HEX API*********
-void hex_null(Hex8* h)
+typedef struct
 {
-    string_fill('\0', h->hex);
-}
+    SplitRun* items;
+    uint64 count;
+    uint64 capacity;
+    bool failed;    // some run was not appended, because memory ran out
+} SplitRunList;
 
-// *********IMPLEMENTATION OF FLAG API*********
-unsigned int parse_arguments(int argc, const char* argv[], int *flags_parameters)
+typedef struct
 {
-    // flags_parameters must be at least size of last value of STR_FLAGS
-    unsigned int flags = 0;
-    Actions action = UNDEFINED;
-    Actions previous_action = UNDEFINED;
+    const uint8* data;
+    uint64 size;            // size of the whole input
+    uint64 start;           // chunk is [start, end)
+    uint64 end;
+    unsigned int word_size;
+    bool utf16;
+    SplitRunList runs[RUN_KINDS_COUNT];
+} SplitChunk;
 
-    // null flags_parameters to be sure
-    for(int i = 0; i <= (ippow(2, FLAGS_COUNT - 1)); ++i)
-        flags_parameters[i] = 0;
+/**
+ * @brief split_is_printable Return true if c belongs to "word" of action_split
+ * @param c
+ * @return 1 or 0 <=> true or false
+ */
+bool split_is_printable(int c);
 
-    for(int i = 1; i < argc; ++i) {
-        if((action = distinguish_action(argv[i])) != UNDEFINED) {
-            flags |= (int)action;
-            if(flag_require_param(action))
-                flags_parameters[action] = (int)MISSING_FLAG_PARAMETER;
-        }
-        else if(string_is_number(argv[i]) && previous_action != UNDEFINED){
-            if(flag_accept_param(previous_action))
-                flags_parameters[previous_action] = string_to_number(argv[i]);
-            else
-                flags_parameters[previous_action] = (int)UNEXPECTED_PARAMETER_ERROR;
-        }
-        previous_action = action;
-    }
+/**
+ * @brief split_run_append Append run to list, on allocation failure the list is
+ * kept as it is and marked as failed
+ * @param list
+ * @param offset Offset of first byte of the run in input
+ * @param len Number of characters
+ * @return 0 if memory ran out, 1 otherwise
+ */
+bool split_run_append(SplitRunList* list, uint64 offset, uint64 len);
 
-    return flags;
-}
+/**
+ * @brief split_scan_chunk Find all runs in chunk, runs shorter than word_size
+ * are kept only if they touch chunk boundary (they can continue in neighbour)
+ * @param arg Pointer to SplitChunk
+ * @return NULL
+ */
+void* split_scan_chunk(void* arg);
 
-bool is_flag(const char* str)
-{
-    if(string_contain('-', str) && string_len(str) >= 2)
-        return true;
-    return false;
-}
+/**
+ * @brief split_stitch Join runs of one kind which were cut by chunk
+ * boundaries and drop runs shorter than word_size
+ * @param chunks Scanned chunks in file order
+ * @param chunks_count
+ * @param kind Kind of runs which will be stitched
+ * @param word_size
+ * @param result Stitched runs in file order
+ */
+void split_stitch(SplitChunk* chunks, unsigned int chunks_count, RunKind kind,
+                  unsigned int word_size, SplitRunList* result);
 
-Actions distinguish_action(const char* str)
+// *********DECLARATION OF REVERSE API*********
+typedef struct
 {
-    char flag_without_param[3] = {'-', '\0', '\0'};
+    const uint8* data;
+    uint64 start;           // chunk is [start, end)
+    uint64 end;
+    uint64 digits;          // number of hex digits before first invalid character
+    uint64 invalid;         // offset of first invalid character, end if there is none
+    int last_digit;         // value of last hex digit, -1 if chunk has none
+    int carry;              // high nibble from previous chunks, -1 if there is none
+    uint8* output;          // decoded bytes
+    uint64 output_len;
+    off_t output_offset;    // position of first decoded byte in output
+    int fd;                 // if >= 0 worker writes output by itself
+    bool failed;
+} ReverseChunk;
 
-    for(int i = 0; i < FLAGS_COUNT; ++i) {
-        flag_without_param[1] = STR_FLAGS[i][1];    // remove flag specifier
-        if(string_compare(str, flag_without_param))
-            return (Actions)(1 << i);
-    }
+/**
+ * @brief reverse_count_chunk Count hex digits in chunk and find
+ * first invalid character
+ * @param arg Pointer to ReverseChunk
+ * @return NULL
+ */
+void* reverse_count_chunk(void* arg);
 
-    return UNDEFINED;
-}
+/**
+ * @brief reverse_decode_chunk Decode hex digits of chunk into its output,
+ * carry and output_offset must be already set by prefix pass
+ * @param arg Pointer to ReverseChunk
+ * @return NULL
+ */
+void* reverse_decode_chunk(void* arg);
 
-bool flag_accept_param(Actions action)
-{
-    if(action == UNDEFINED)
-        return false;
+// *********DECLARATION OF DAEMON API*********
+// Request is DaemonRequest followed by args_len bytes of '\0' terminated arguments
+// (without program name) and payload_len bytes of payload (path or inline data),
+// for DAEMON_INPUT_FD input descriptor is passed by SCM_RIGHTS together with header.
+// Response is sequence of DaemonFrame followed by len bytes of data, last frame
+// is DAEMON_FRAME_EXIT with exit status stored in uint32.
+#define DAEMON_MAGIC 0x315a5049u     // "IZP1"
 
-    int index_of_flag = 0;
-    int iaction = (int)action;
+const unsigned int daemon_max_args = 64;
+const unsigned int daemon_max_args_len = 1 << 16;
+const uint64 daemon_max_payload_len = 1 << 26;
+const unsigned int daemon_buffer_size = 1 << 16;
 
-    while(iaction >>= 1)
-        ++index_of_flag;
+typedef enum
+{
+    DAEMON_INPUT_FD = 0,
+    DAEMON_INPUT_PATH = 1,
+    DAEMON_INPUT_INLINE = 2
+} DaemonInput;
 
-    return string_contain('%', STR_FLAGS[index_of_flag]) || string_contain('&', STR_FLAGS[index_of_flag]);
-}
+typedef enum
+{
+    DAEMON_FRAME_OUTPUT = 1,
+    DAEMON_FRAME_ERROR = 2,
+    DAEMON_FRAME_EXIT = 3
+} DaemonFrameType;
 
-bool flag_require_param(Actions action)
+typedef struct
 {
-    if(action == UNDEFINED)
-        return false;
+    uint32 magic;
+    uint32 input;           // DaemonInput
+    uint32 argc;            // number of arguments without program name
+    uint32 args_len;
+    uint64 payload_len;
+} DaemonRequest;
 
-    int index_of_flag = 0;
-    int iaction = (int)action;
+typedef struct
+{
+    uint32 type;            // DaemonFrameType
+    uint32 len;
+} DaemonFrame;
 
-    while(iaction >>= 1)
+typedef struct
+{
+    int socket;
+    DaemonFrameType type;
+} DaemonStream;
+
+typedef struct
+{
+    int listen_socket;
+    char* args;             // buffers are reused by all requests of worker
+    uint64 args_capacity;
+    uint8* payload;
+    uint64 payload_capacity;
+    char* output_buffer;
+} DaemonWorker;
+
+/**
+ * @brief socket_send_all Send whole buffer, retry on partial sends
+ * @param socket
+ * @param buffer
+ * @param len
+ * @return 1 or 0 <=> true or false
+ */
+bool socket_send_all(int socket, const void* buffer, uint64 len);
+
+/**
+ * @brief socket_recv_all Receive exactly len bytes
+ * @param socket
+ * @param buffer
+ * @param len
+ * @return 1 or 0 <=> true or false, false also if peer closed connection
+ */
+bool socket_recv_all(int socket, void* buffer, uint64 len);
+
+/**
+ * @brief daemon_send_frame Send one response frame
+ * @param socket
+ * @param type
+ * @param data
+ * @param len
+ * @return 1 or 0 <=> true or false
+ */
+bool daemon_send_frame(int socket, DaemonFrameType type, const void* data, uint32 len);
+
+/**
+ * @brief daemon_send_request Send request header, pass fd if it is >= 0
+ * @param socket
+ * @param request
+ * @param fd
+ * @return 1 or 0 <=> true or false
+ */
+bool daemon_send_request(int socket, const DaemonRequest* request, int fd);
+
+/**
+ * @brief daemon_recv_request Receive request header and passed descriptor
+ * @param socket
+ * @param request
+ * @param fd Passed descriptor or -1
+ * @return 1 or 0 <=> true or false
+ */
+bool daemon_recv_request(int socket, DaemonRequest* request, int* fd);
+
+/**
+ * @brief daemon_reserve Grow buffer to at least size bytes
+ * @param buffer
+ * @param capacity
+ * @param size
+ * @return 1 or 0 <=> true or false
+ */
+bool daemon_reserve(void** buffer, uint64* capacity, uint64 size);
+
+/**
+ * @brief daemon_stream_write Write callback of fopencookie, which sends
+ * data as frames of type stored in cookie
+ */
+ssize_t daemon_stream_write(void* cookie, const char* buffer, size_t size);
+
+/**
+ * @brief daemon_handle Read one request from client, run it and send result
+ * @param worker Worker with its reused buffers
+ * @param client Connected socket
+ */
+void daemon_handle(DaemonWorker* worker, int client);
+
+/**
+ * @brief daemon_worker Accept and handle requests until listening fails
+ * @param arg Pointer to DaemonWorker
+ * @return NULL
+ */
+void* daemon_worker(void* arg);
+
+/**
+ * @brief daemon_serve Listen on Unix domain socket and run requests
+ * in pool of worker threads
+ * @param path Path of socket
+ * @param threads Number of workers, if <= 0 use number of online cpus
+ * @return EXIT_FAILURE if socket can not be created, otherwise does not return
+ */
+int daemon_serve(const char* path, int threads);
+
+/**
+ * @brief daemon_client Send arguments and stdin to daemon, copy its output
+ * to stdout and stderr
+ * @param path Path of socket
+ * @param argc
+ * @param argv All arguments of program
+ * @param skip Index of -C parameter, it and -C are not sent
+ * @param status Exit status returned by daemon
+ * @return 0 if daemon is not reachable, 1 otherwise
+ */
+bool daemon_client(const char* path, int argc, const char* argv[], int skip, int* status);
+
+// *********DECLARATION OF CHECKSUM API*********
+const unsigned int checksum_default_block = 4096;
+
+typedef enum
+{
+    CHECKSUM_NONE = 0,
+    CHECKSUM_CRC32C = 1,
+    CHECKSUM_XXH64 = 2
+} ChecksumKind;
+
+typedef struct
+{
+    ChecksumKind kind;
+    uint64 len;             // bytes in current block
+    uint32 crc;
+    uint64 acc[4];          // xxh64 accumulators
+    uint8 stripe[32];       // xxh64 bytes which do not fill whole stripe yet
+    uint32 stripe_len;
+} Checksum;
+
+/**
+ * @brief crc32c_update Continue CRC32C (Castagnoli) of data, uses SSE4.2
+ * instruction if cpu has it
+ * @param crc Previous value, 0 for first call
+ * @param data
+ * @param len
+ * @return New value
+ */
+uint32 crc32c_update(uint32 crc, const uint8* data, uint64 len);
+
+/**
+ * @brief checksum_reset Start new block
+ * @param sum
+ * @param kind
+ */
+void checksum_reset(Checksum* sum, ChecksumKind kind);
+
+/**
+ * @brief checksum_update Add data to current block
+ * @param sum
+ * @param data
+ * @param len
+ */
+void checksum_update(Checksum* sum, const uint8* data, uint64 len);
+
+/**
+ * @brief checksum_value Return checksum of current block
+ * @param sum
+ * @return Checksum, crc32c uses only lower 32 bits
+ */
+uint64 checksum_value(const Checksum* sum);
+
+/**
+ * @brief checksum_name Return name used in checksum lines
+ * @param kind
+ * @return Name
+ */
+const char* checksum_name(ChecksumKind kind);
+
+/**
+ * @brief checksum_kind Find checksum kind by its name
+ * @param name
+ * @return Kind, CHECKSUM_NONE if name is unknown
+ */
+ChecksumKind checksum_kind(const char* name);
+
+/**
+ * @brief checksum_print Print checksum line of finished block and start new one,
+ * line is "#NAME OFFSET LENGTH VALUE" (hex numbers), print nothing for empty block
+ * @param sum
+ * @param offset Offset of first byte of block
+ */
+void checksum_print(Checksum* sum, uint64 offset);
+
+// *********DECLARATION OF WORD API*********
+typedef enum
+{
+    WORD_UNSIGNED = 'u',
+    WORD_SIGNED = 's',
+    WORD_HEX = 'x',
+    WORD_FLOAT = 'f'
+} WordClass;
+
+typedef struct
+{
+    WordClass cls;
+    uint32 size;            // 1, 2, 4 or 8 bytes
+    bool big_endian;
+} WordType;
+
+/**
+ * @brief word_type_parse Parse type like u32le, s16be, x64, f64be,
+ * default endianness is little endian
+ * @param spec
+ * @param type Parsed type
+ * @return 1 or 0 <=> true or false
+ */
+bool word_type_parse(const char* spec, WordType* type);
+
+/**
+ * @brief word_width Return number of characters of one printed word
+ * @param type
+ * @return Width
+ */
+uint32 word_width(const WordType* type);
+
+/**
+ * @brief words_decode Load count words from data and convert them to host
+ * byte order, whole array is swapped in one loop, so compiler can vectorize it
+ * @param data Packed words, count * type->size bytes
+ * @param count
+ * @param type
+ * @param values Decoded words, zero extended
+ */
+void words_decode(const uint8* data, uint32 count, const WordType* type, uint64* values);
+
+/**
+ * @brief word_format Print word right aligned to word_width characters,
+ * output is not '\0' terminated
+ * @param type
+ * @param value Word decoded by words_decode
+ * @param out Buffer with at least word_width + 1 characters
+ * @return Pointer behind last written character
+ */
+char* word_format(const WordType* type, uint64 value, char* out);
+
+// *********DECLARATION OF SAMPLE API*********
+const unsigned int sample_default_block = 64;
+
+/**
+ * @brief sample_random Next pseudo random number of splitmix64 sequence
+ * @param state Seed, it is advanced
+ * @return Random number
+ */
+uint64 sample_random(uint64* state);
+
+/**
+ * @brief sample_offsets Choose distinct random blocks of input,
+ * blocks are aligned to block from start
+ * @param start First byte which can be sampled
+ * @param size Size of input
+ * @param block Size of one block, > 0
+ * @param count Number of blocks to choose, it is set to number of chosen
+ * blocks, which is less if input has less blocks
+ * @param seed
+ * @param offsets Array of count elements, chosen offsets are stored sorted in it
+ * @return 0 if memory ran out, 1 otherwise
+ */
+bool sample_offsets(uint64 start, uint64 size, uint64 block, uint64* count, uint64 seed, uint64* offsets);
+
+/**
+ * @brief sample_read Read block at offset of current input, pread is used
+ * on seekable descriptor, fseek on seekable stream, otherwise offsets must be
+ * ascending and input is skipped to them
+ * @param offset
+ * @param data Buffer for len bytes
+ * @param len
+ * @param position Offset of next byte of non-seekable input, updated
+ * @return Number of read bytes, less than len at end of input
+ */
+uint64 sample_read(uint64 offset, uint8* data, uint64 len, uint64* position);
+
+/**
+ * @brief sample_print Print block in action_default layout
+ * @param address Offset of data[0] in input
+ * @param data
+ * @param len
+ */
+void sample_print(uint64 address, const uint8* data, uint64 len);
+
+// *********DECLARATION OF SCAN API*********
+#define SIGNATURE_NAME_SIZE 32
+
+typedef struct
+{
+    char name[SIGNATURE_NAME_SIZE];
+    uint8* bytes;
+    uint32 len;
+} Signature;
+
+typedef struct
+{
+    Signature* items;
+    uint32 count;
+    uint32 capacity;
+} SignatureSet;
+
+typedef struct
+{
+    uint32* next;           // states * 256 transitions, automaton is complete DFA
+    int* match;             // signature ending in state, -1 if none
+    uint32* output;         // nearest state on failure path with match, 0 if none
+    uint32 states;
+} Automaton;
+
+/**
+ * @brief signature_add Append copy of signature to set
+ * @param set
+ * @param name Truncated to SIGNATURE_NAME_SIZE - 1 characters
+ * @param bytes
+ * @param len Must be > 0
+ * @return 0 if out of memory or len == 0, 1 otherwise
+ */
+bool signature_add(SignatureSet* set, const char* name, const uint8* bytes, uint32 len);
+
+/**
+ * @brief signature_parse Parse line "NAME HEX", whitespace in HEX is ignored,
+ * empty lines and lines starting with '#' are skipped
+ * @param set Parsed signature is appended to it
+ * @param line
+ * @return 0 if line is invalid, 1 otherwise
+ */
+bool signature_parse(SignatureSet* set, const char* line);
+
+/**
+ * @brief signature_builtin Append magic numbers of common embedded files
+ * @param set
+ * @return 0 if out of memory, 1 otherwise
+ */
+bool signature_builtin(SignatureSet* set);
+
+/**
+ * @brief signature_load Append signatures from file, one signature_parse line each
+ * @param set
+ * @param path
+ * @param line Number of invalid line, 0 if file can not be read
+ * @return 1 if whole file was loaded, 0 otherwise
+ */
+bool signature_load(SignatureSet* set, const char* path, uint32* line);
+
+/**
+ * @brief signature_free Free all signatures of set
+ * @param set
+ */
+void signature_free(SignatureSet* set);
+
+/**
+ * @brief automaton_build Build Aho-Corasick automaton of set, every state has
+ * transition for each byte, so scanning does not depend on number of signatures
+ * @param automaton
+ * @param set
+ * @return 0 if out of memory, 1 otherwise
+ */
+bool automaton_build(Automaton* automaton, const SignatureSet* set);
+
+/**
+ * @brief automaton_free Free tables of automaton
+ * @param automaton
+ */
+void automaton_free(Automaton* automaton);
+
+/**
+ * @brief automaton_scan Feed data to automaton, hit is called for every
+ * signature ending in data
+ * @param automaton
+ * @param set Set automaton was built from
+ * @param state State after previous data, 0 at start of input
+ * @param data
+ * @param len
+ * @param address Offset of data[0] in input
+ * @param hit Called with arg, offset of first byte of signature and its index
+ * @param arg
+ * @return State after data
+ */
+uint32 automaton_scan(const Automaton* automaton, const SignatureSet* set, uint32 state,
+                      const uint8* data, uint64 len, uint64 address,
+                      void (*hit)(void*, uint64, uint32), void* arg);
+
+// *********DECLARATION OF DUMP API*********
+// short last line of action_default is padded, so length of line depends
+// only on digits of address, which has at least 8 digits
+#define DUMP_LINE_LEN 79
+#define DUMP_EMPTY_LINE_LEN 69
+
+typedef struct
+{
+    const uint8* data;      // first dumped byte of input
+    uint64 start;           // lines of chunk, multiple of 16
+    uint64 end;
+    uint64 address;         // address of data[0]
+    char* out;              // output of whole dump
+} DumpChunk;
+
+/**
+ * @brief dump_line_len Length of line of action_default starting at address
+ * @param address
+ * @return DUMP_LINE_LEN for addresses with 8 digits, one more for each other digit
+ */
+unsigned int dump_line_len(uint64 address);
+
+/**
+ * @brief dump_offset Number of bytes of first lines of action_default
+ * @param address Address of first line
+ * @param lines
+ * @return Offset of line with index lines
+ */
+uint64 dump_offset(uint64 address, uint64 lines);
+
+/**
+ * @brief dump_size Exact number of bytes action_default prints for len bytes
+ * @param address Address of first byte
+ * @param len
+ * @return Size of output
+ */
+uint64 dump_size(uint64 address, uint64 len);
+
+/**
+ * @brief dump_line Render one line of action_default, output is not '\0' terminated
+ * @param out Buffer of dump_line_len(address) characters
+ * @param address
+ * @param data
+ * @param n Number of bytes of line, 1 - 16
+ */
+void dump_line(char* out, uint64 address, const uint8* data, unsigned int n);
+
+/**
+ * @brief dump_chunk Render lines of DumpChunk to their position in output
+ * @param arg Pointer to DumpChunk
+ * @return NULL
+ */
+void* dump_chunk(void* arg);
+
+// *********DECLARATION OF PROCESS API*********
+#define PROCESS_NAME_SIZE 256
+
+typedef struct
+{
+    uint64 start;
+    uint64 end;
+    bool readable;
+    char name[PROCESS_NAME_SIZE];   // path or [heap] etc., empty for anonymous mapping
+} ProcessRegion;
+
+/**
+ * @brief process_parse_region Parse line of /proc/PID/maps
+ * @param line
+ * @param region
+ * @return 1 or 0 <=> true or false
+ */
+bool process_parse_region(const char* line, ProcessRegion* region);
+
+/**
+ * @brief process_parse_range Parse range "START-END" of hex addresses,
+ * optional 0x prefixes are accepted
+ * @param str
+ * @param start
+ * @param end First address behind range
+ * @return 0 if str is not range or START > END, 1 otherwise
+ */
+bool process_parse_range(const char* str, uint64* start, uint64* end);
+
+/**
+ * @brief process_regions Load mappings of process
+ * @param pid
+ * @param regions Allocated array, must be freed
+ * @param count
+ * @return 0 if maps can not be read, 1 otherwise
+ */
+bool process_regions(int pid, ProcessRegion** regions, uint32* count);
+
+/**
+ * @brief process_read Read memory of process, every page has its own iovec,
+ * so read stops at first unmapped page
+ * @param pid
+ * @param address
+ * @param data
+ * @param len
+ * @return Number of bytes read before first unreadable page, -1 if process
+ * can not be read at all
+ */
+ssize_t process_read(int pid, uint64 address, uint8* data, uint64 len);
+
+// *********DECLARATION OF ELF API*********
+#define ELF_NAME_SIZE 64
+
+typedef struct
+{
+    bool is64;
+    bool big_endian;
+    uint64 shoff;           // section header table
+    uint32 shentsize;
+    uint32 shnum;
+    uint32 shstrndx;
+    uint64 phoff;           // program header table
+    uint32 phentsize;
+    uint32 phnum;
+} ElfHeader;
+
+typedef struct
+{
+    char name[ELF_NAME_SIZE];
+    uint32 name_offset;     // into section name table, unused by segments
+    uint32 type;
+    uint64 address;
+    uint64 offset;
+    uint64 size;            // size in file, 0 for .bss etc.
+} ElfRegion;
+
+/**
+ * @brief elf_value Read little or big endian number of size bytes
+ * @param data
+ * @param size 1 - 8
+ * @param big_endian
+ * @return Value
+ */
+uint64 elf_value(const uint8* data, unsigned int size, bool big_endian);
+
+/**
+ * @brief elf_parse_header Parse ELF header of 32 or 64 bit file of any endianness
+ * @param data First bytes of file
+ * @param len At least 64 bytes for 64 bit file, 52 for 32 bit
+ * @param header
+ * @return 0 if data are not ELF header, 1 otherwise
+ */
+bool elf_parse_header(const uint8* data, uint64 len, ElfHeader* header);
+
+/**
+ * @brief elf_parse_section Parse entry of section header table, name is not set
+ * @param header
+ * @param entry
+ * @param section
+ */
+void elf_parse_section(const ElfHeader* header, const uint8* entry, ElfRegion* section);
+
+/**
+ * @brief elf_parse_segment Parse entry of program header table, name is
+ * PT_ type of segment followed by its index
+ * @param header
+ * @param entry
+ * @param index Index among segments of same type
+ * @param segment
+ */
+void elf_parse_segment(const ElfHeader* header, const uint8* entry, uint32 index, ElfRegion* segment);
+
+/**
+ * @brief elf_segment_type Name of segment type
+ * @param type
+ * @return "PT_LOAD" etc., "PT_UNKNOWN" for unknown types
+ */
+const char* elf_segment_type(uint32 type);
+
+/**
+ * @brief elf_name_match Compare requested name with region name, segments
+ * are matched by type name (PT_LOAD) or by type name with index (PT_LOAD[2])
+ * @param region
+ * @param segment Region is segment
+ * @param name
+ * @return 1 or 0 <=> true or false
+ */
+bool elf_name_match(const ElfRegion* region, bool segment, const char* name);
+
+// *********DECLARATION OF CACHE API*********
+#define CACHE_KEY_SIZE 34           // "%016llx-%016llx" and '\0'
+
+const unsigned int cache_default_limit = 1024;     // MiB
+
+typedef struct
+{
+    const char* dir;
+    char path[PATH_MAX];            // entry of current input and flags
+    char temp[PATH_MAX];            // output is recorded here before it is complete
+    int fd;
+    bool failed;                    // output must not be stored
+    IoContext io;                   // context which records output
+    IoContext* previous;
+} Cache;
+
+/**
+ * @brief cache_key Name of cache entry, hash of input and of parsed flags
+ * which change output, so order of flags and -j etc. do not matter
+ * @param flags Flags from parse_arguments
+ * @param params Parameters from parse_arguments
+ * @param argv String parameters are taken from it
+ * @param input_hash Hash of whole input
+ * @param key Buffer of CACHE_KEY_SIZE characters
+ */
+void cache_key(int flags, const int64* params, const char* argv[], uint64 input_hash, char* key);
+
+/**
+ * @brief cache_lookup Hash current input and find path of its entry, input
+ * must be regular file and output must depend only on input and flags
+ * @param cache
+ * @param dir Cache directory
+ * @param flags
+ * @param params
+ * @param argv
+ * @return 0 if output can not be cached, 1 otherwise
+ */
+bool cache_lookup(Cache* cache, const char* dir, int flags, const int64* params, const char* argv[]);
+
+/**
+ * @brief cache_serve Copy cached entry to current output, with sendfile
+ * if output has descriptor, entry becomes most recently used, entry larger
+ * than limit is removed instead
+ * @param cache
+ * @param status EXIT_FAILURE if output can not be written
+ * @param limit Maximal size of cache directory in bytes
+ * @return 0 if entry does not exist, 1 otherwise
+ */
+bool cache_serve(Cache* cache, int* status, uint64 limit);
+
+/**
+ * @brief cache_begin Replace current output by one which is also recorded,
+ * entry gets permissions given by umask, so cache can be shared
+ * @param cache
+ * @return 0 if recording is not possible (nothing is changed), 1 otherwise
+ */
+bool cache_begin(Cache* cache);
+
+/**
+ * @brief cache_end Stop recording and restore previous context, recorded
+ * output is stored only if store is set, no error was printed and it fits into limit
+ * @param cache
+ * @param store
+ * @param limit Maximal size of cache directory in bytes
+ */
+void cache_end(Cache* cache, bool store, uint64 limit);
+
+/**
+ * @brief cache_evict Remove least recently used entries until directory fits into limit
+ * @param dir
+ * @param limit Size in bytes
+ */
+void cache_evict(const char* dir, uint64 limit);
+
+// *********DECLARATION OF ACTION API*********
+typedef struct
+{
+    uint32 checksum_block;          // checksum line after every block, 0 = no checksums
+    ChecksumKind checksum_kind;
+    WordType word;                  // used only by action_typed
+} DumpFormat;
+
+/**
+ * @brief action_unformated_hex Takes str from stdin and print it as hex
+ * @param format Checksums, block is put on its own line before checksum
+ */
+void action_unformated_hex(const DumpFormat* format);
+
+/**
+ * @brief action_reverse Convert hex str from stdin to str, ignor whitespace etc.
+ * @return EXIT_SUCCESS or EXIT_FAILURE if input contains invalid character
+ */
+int action_reverse();
+
+/**
+ * @brief action_reverse_verify Same as action_reverse, but input contains
+ * checksum lines printed by -c, every block is written only if its checksum
+ * match
+ * @return EXIT_SUCCESS or EXIT_FAILURE if input is invalid or checksum does not match
+ */
+int action_reverse_verify();
+
+/**
+ * @brief action_reverse_parallel Same as action_reverse, but stdin is decoded
+ * by several threads, if stdout is regular file each thread writes its part
+ * directly to its position, stdin which is not regular file is read into
+ * memory first
+ * @param threads Number of threads, if <= 0 use number of online cpus
+ * @return EXIT_SUCCESS or EXIT_FAILURE if input contains invalid character
+ */
+int action_reverse_parallel(int threads);
+
+/**
+ * @brief action_split Split string from stdin to "words", split by \n, \0 etc.
+ * @param word_size Word must be at least >= count
+ */
+void action_split(unsigned int word_size);
+
+/**
+ * @brief action_split_parallel Same as action_split, but whole stdin is
+ * scanned by several threads, output is in file order and matches action_split
+ * @param word_size Word must be at least >= count
+ * @param threads Number of threads, if <= 0 use number of online cpus
+ * @param offsets Print offset of each word in front of it
+ * @param utf16 Find also UTF-16LE words
+ * @return EXIT_SUCCESS or EXIT_FAILURE if input can not be read
+ */
+int action_split_parallel(unsigned int word_size, int threads, bool offsets, bool utf16);
+
+/**
+ * @brief action_default Printf address character in hex, 16 chars per line
+ * @param address Define how many skip chars
+ * @param count If count == -1, then ignore count
+ * @param format Checksums, block must be multiple of 16
+ */
+void action_default(uint64 address, int64 count, const DumpFormat* format);
+
+/**
+ * @brief action_typed Same layout as action_default, but bytes of line are
+ * printed as words of format->word type
+ * @param address Define how many skip chars
+ * @param count If count == -1, then ignore count
+ * @param format Word type and checksums, block must be multiple of 16
+ * @return EXIT_SUCCESS or EXIT_FAILURE if output can not be allocated
+ */
+int action_typed(uint64 address, int64 count, const DumpFormat* format);
+
+/**
+ * @brief action_default_file Same output as action_default, but it is written
+ * to file, which is allocated to exact size first, and lines are rendered
+ * by several threads directly to their positions
+ * @param address Define how many skip chars
+ * @param count If count == -1, then ignore count
+ * @param path Output file, it is truncated
+ * @param threads Number of threads, if <= 0 use number of online cpus
+ * @return EXIT_SUCCESS or EXIT_FAILURE if input can not be read or file written
+ */
+int action_default_file(uint64 address, int64 count, const char* path, int threads);
+
+/**
+ * @brief action_process Print memory of running process in action_default
+ * layout with virtual addresses, unreadable pages are skipped
+ * @param pid
+ * @param selection Range "START-END" or substring of mapping name,
+ * NULL means all readable mappings
+ * @param count If count == -1, then ignore count
+ * @return EXIT_SUCCESS or EXIT_FAILURE if process can not be read or nothing
+ * of selected mappings can be read
+ */
+int action_process(int pid, const char* selection, int64 count);
+
+/**
+ * @brief action_elf Print sections and segments of ELF input in action_default
+ * layout with virtual addresses, other parts of file are not read
+ * @param names Names separated by ',', e.g. ".rodata,.data,PT_LOAD"
+ * @return EXIT_SUCCESS or EXIT_FAILURE if input is not seekable ELF file or
+ * some name is not found
+ */
+int action_elf(const char* names);
+
+/**
+ * @brief action_sample Print blocks sampled from input in action_default layout
+ * with their true addresses, input between blocks is not read if it is seekable
+ * @param start Define how many skip chars
+ * @param block Size of one sample
+ * @param every Distance between starts of samples, 0 if samples are random
+ * @param count Number of random samples
+ * @param seed Seed of random samples
+ * @return EXIT_SUCCESS or EXIT_FAILURE if random samples are requested from
+ * input with unknown size
+ */
+int action_sample(uint64 start, uint64 block, uint64 every, uint64 count, uint64 seed);
+
+/**
+ * @brief action_scan Find signatures in input in one pass, print offset and
+ * name of every hit
+ * @param set
+ * @param context Number of bytes from hit printed in action_default layout, 0 = none
+ * @return EXIT_SUCCESS or EXIT_FAILURE if automaton can not be built
+ */
+int action_scan(const SignatureSet* set, uint32 context);
+
+/**
+ * @brief print_help Print allowed combinations of flags
+ */
+void print_help();
+
+/**
+ * @brief print_error Print specific error
+ * @param err
+ */
+void print_error(Errors err);
+
+/**
+ * @brief run_actions Run specific actions according to flags
+ * @param flags
+ * @param params Number parameters of flags
+ * @param argc
+ * @param argv Arguments, string parameters are indexes into it
+ * @return 0 if successfull otherwise 1
+ */
+int run_actions(int flags, int64* params, int argc, const char* argv[]);
+
+/**
+ * @brief run_arguments Validate arguments, parse them and run actions
+ * @param argc
+ * @param argv
+ * @return 0 if successfull otherwise 1
+ */
+int run_arguments(int argc, const char* argv[]);
+
+// NOTE Main
+int main(int argc, const char *argv[])
+{
+#ifdef NDEBUG
+    test_math_api();
+    test_string_api();
+    test_hex_api();
+    test_flag_api();
+    test_split_api();
+    test_checksum_api();
+    test_throttle_api();
+    test_word_api();
+    test_sample_api();
+    test_scan_api();
+    test_dump_api();
+    test_process_api();
+    test_elf_api();
+    test_cache_api();
+    TST_TOTAL();
+#endif
+
+    return run_arguments(argc, argv);
+}
+
+int run_arguments(int argc, const char* argv[])
+{
+    int64 params[FLAGS_COUNT];
+    int flags = parse_arguments(argc, argv, params);
+
+    // check for unexpected  params and flags
+    Errors err = flags_validation(argc, argv);
+    print_error(err);
+
+    if(err != NO_ERROR) {
+        print_help();
+        return EXIT_SUCCESS;
+    }
+
+    // run actions
+    return run_actions(flags, params, argc, argv);
+}
+
+// *********IMPLEMENTATION OF MATH API*********
+int ippow(int base, unsigned int exp)
+{
+    if(exp == 0)
+        return 1;
+
+    int result = base;
+
+    while(--exp)
+        result *= base;
+
+    return result;
+}
+
+// *********IMPLEMENTATION OF STRING API*********
+bool string_compare(const char* str1, const char* str2)
+{
+    if(string_len(str1) != string_len(str2))
+        return false;
+
+    while(*str1) {
+        if(*str1++ != *str2++)
+            return false;
+    }
+
+    return true;
+}
+
+// NOTE return actually only number >= 0
+unsigned int string_len(const char* str)
+{
+    int size = 0;
+
+    while(*str++)
+        ++size;
+
+    return size;
+}
+
+bool string_contain(char c, const char* str)
+{
+    while(*str) {
+        if(c == *str++)
+            return true;
+    }
+
+    return false;
+}
+
+// NOTE return actually only number >= 0
+unsigned int string_count(char c, const char* str)
+{
+    int count = 0;
+
+    while(*str) {
+        if(c == *str++)
+            ++count;
+    }
+
+    return count;
+}
+
+bool string_is_number(const char* str)
+{
+    while(*str) {
+        if(!isdigit(*str))
+            return false;
+        ++str;
+    }
+
+    return true;
+}
+
+int64 string_to_number(const char* str)
+{
+    if(!string_is_number(str))
+        return -1;
+
+    int64 result = 0;
+
+    while(*str) {
+        const int digit = *str++ - '0';
+
+        if(result > (LLONG_MAX - digit) / 10)
+            return -1;
+        result = result * 10 + digit;
+    }
+
+    return result;
+}
+
+char* string_fill(char fill, char* str)
+{
+    char *orig = str;   // because str pointer is being modified
+
+    while(*str)
+        *str++ = fill;
+    return orig;
+}
+
+void nprintf(char c, unsigned int count)
+{
+    while(count--)
+        io_printf("%c", c);
+}
+
+// *********IMPLEMENTATION OF HEX API*********
+void hex_null(Hex8* h)
+{
+    string_fill('\0', h->hex);
+}
+
+uint8 hex_classify(int c)
+{
+    if(isdigit(c))
+        return c - '0';
+    else if(isxdigit(c))
+        return tolower(c) - 'a' + 10;
+    else if(isspace(c))
+        return HEX_SPACE;
+    return HEX_INVALID;
+}
+
+// *********IMPLEMENTATION OF FLAG API*********
+unsigned int parse_arguments(int argc, const char* argv[], int64* flags_parameters)
+{
+    // flags_parameters must have FLAGS_COUNT elements
+    unsigned int flags = 0;
+    Actions action = UNDEFINED;
+    Actions previous_action = UNDEFINED;
+
+    // null flags_parameters to be sure
+    for(int i = 0; i < FLAGS_COUNT; ++i)
+        flags_parameters[i] = 0;
+
+    for(int i = 1; i < argc; ++i) {
+        if(flag_require_string(previous_action)) {
+            // anything is accepted as string param, even something looking like flag
+            flags_parameters[flag_index(previous_action)] = i;
+            action = UNDEFINED;
+        }
+        else if((action = distinguish_action(argv[i])) != UNDEFINED) {
+            flags |= (int)action;
+            if(flag_require_param(action))
+                flags_parameters[flag_index(action)] = (int)MISSING_FLAG_PARAMETER;
+        }
+        else if(string_is_number(argv[i]) && previous_action != UNDEFINED){
+            if(flag_accept_param(previous_action))
+                flags_parameters[flag_index(previous_action)] = string_to_number(argv[i]);
+            else
+                flags_parameters[flag_index(previous_action)] = (int)UNEXPECTED_PARAMETER_ERROR;
+        }
+        previous_action = action;
+    }
+
+    return flags;
+}
+
+bool is_flag(const char* str)
+{
+    if(string_contain('-', str) && string_len(str) >= 2)
+        return true;
+    return false;
+}
+
+Actions distinguish_action(const char* str)
+{
+    char flag_without_param[3] = {'-', '\0', '\0'};
+
+    for(int i = 0; i < FLAGS_COUNT; ++i) {
+        flag_without_param[1] = STR_FLAGS[i][1];    // remove flag specifier
+        if(string_compare(str, flag_without_param))
+            return (Actions)(1 << i);
+    }
+
+    return UNDEFINED;
+}
+
+bool flag_accept_param(Actions action)
+{
+    if(action == UNDEFINED)
+        return false;
+
+    const int index_of_flag = flag_index(action);
+
+    return string_contain('%', STR_FLAGS[index_of_flag]) || string_contain('&', STR_FLAGS[index_of_flag]) ||
+           string_contain('$', STR_FLAGS[index_of_flag]);
+}
+
+bool flag_require_param(Actions action)
+{
+    if(action == UNDEFINED)
+        return false;
+
+    const int index_of_flag = flag_index(action);
+
+    return string_contain('&', STR_FLAGS[index_of_flag]) || string_contain('$', STR_FLAGS[index_of_flag]);
+}
+
+bool flag_require_string(Actions action)
+{
+    if(action == UNDEFINED)
+        return false;
+
+    return string_contain('$', STR_FLAGS[flag_index(action)]);
+}
+
+int flag_index(Actions action)
+{
+    int index_of_flag = 0;
+    int iaction = (int)action;
+
+    while(iaction >>= 1)
         ++index_of_flag;
 
-    return string_contain('&', STR_FLAGS[index_of_flag]);
+    return index_of_flag;
+}
+
+Errors flags_validation(int argc, const char* argv[])
+{
+    int previous_arg_was_flag = false;
+    int previous_flag_required_flag = false;
+    int previous_flag_required_string = false;
+    int flags = 0;
+    Actions action;
+
+    for(int i = 1; i < argc; ++i) {
+        // anything is accepted as string param
+        if(previous_flag_required_string) {
+            previous_arg_was_flag = false;
+            previous_flag_required_flag = false;
+            previous_flag_required_string = false;
+        }
+
+        else if(flag_is_allowed(argv[i]) && !previous_flag_required_flag) {
+            action = distinguish_action(argv[i]);
+            // check for duplcations
+            if(flags & (int)action)
+                return FLAG_DUPLICATION;
+
+            flags |= (int)action;
+            previous_arg_was_flag = true;
+            previous_flag_required_flag = flag_require_param(action);
+            previous_flag_required_string = flag_require_string(action);
+        }
+
+        // if current arg is number and previous was allowed flag and flag accept param
+        else if(string_is_number(argv[i])) {
+            int flag_accept_parameter = flag_accept_param(distinguish_action(argv[i - 1]));
+
+            if(previous_arg_was_flag && !flag_accept_parameter)
+                return FLAG_NOT_EXPECT_PARAMETER_ERROR;
+            else if(!previous_arg_was_flag)
+                return UNEXPECTED_PARAMETER_ERROR;
+            // number does not fit into int64
+            else if(string_to_number(argv[i]) < 0)
+                return UNEXPECTED_PARAMETER_ERROR;
+            previous_arg_was_flag = false;
+            previous_flag_required_flag = false;
+        }
+
+        else if(previous_flag_required_flag)
+            return MISSING_FLAG_PARAMETER;
+        else
+            return UNKNOWN_INPUT_ERROR;
+    }
+
+    if(previous_flag_required_flag)
+        return MISSING_FLAG_PARAMETER;
+
+    return NO_ERROR;
+}
+
+bool flag_is_allowed(const char* str_flag)
+{
+    if(string_len(str_flag) < 2)
+        return false;
+
+    const uint32 str_flag_len = string_len(str_flag);
+    char cleared_flag[3] = {'\0', '\0', '\0'};
+
+    for(int i = 0; i < FLAGS_COUNT; ++i) {
+        // match symbol and has '-' and lenghts are equal
+        if(string_contain(STR_FLAGS[i][1], str_flag) && str_flag[0] == '-') {
+            cleared_flag[0] = STR_FLAGS[i][0];
+            cleared_flag[1] = STR_FLAGS[i][1];
+            // beacause if accept param, there is additionally one speciefer(ont symbol);
+            if(flag_accept_param(distinguish_action(cleared_flag)))
+                return (string_len(STR_FLAGS[i]) - 1) == str_flag_len;
+            else
+                return string_len(STR_FLAGS[i]) == str_flag_len;
+        }
+    }
+
+    return false;
+}
+
+// *********IMPLEMENTATION OF IO API*********
+static __thread IoContext* io_current = NULL;
+static IoContext io_standard;
+
+IoContext* io_context()
+{
+    if(io_current == NULL) {
+        // stdin etc. are not constants, so they can not be in static initializer
+        IoContext standard = {stdin, stdout, stderr, STDIN_FILENO, STDOUT_FILENO, -1};
+        io_standard = standard;
+        io_current = &io_standard;
+    }
+
+    return io_current;
+}
+
+void io_set_context(IoContext* io)
+{
+    io_current = io;
+}
+
+int io_getc()
+{
+    return getc(io_context()->in);
+}
+
+bool io_skip(uint64 n)
+{
+    IoContext* io = io_context();
+    off_t size = io->in_size;
+    struct stat st;
+
+    if(size < 0 && io->in_fd >= 0 && fstat(io->in_fd, &st) == 0 && S_ISREG(st.st_mode))
+        size = st.st_size;
+
+    // seek, but not behind end, reading would stop there too
+    const off_t position = (size >= 0) ?ftello(io->in) :-1;
+    if(position >= 0 && position <= size) {
+        const bool inside = (uint64)(size - position) >= n;
+
+        if(fseeko(io->in, (inside) ?position + (off_t)n :size, SEEK_SET) == 0)
+            return inside;
+    }
+
+    while(n--) {
+        if(io_getc() == EOF)
+            return false;
+    }
+
+    return true;
+}
+
+void io_printf(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vfprintf(io_context()->out, format, args);
+    va_end(args);
+}
+
+void io_write(const void* buffer, uint64 len)
+{
+    fwrite(buffer, 1, len, io_context()->out);
+}
+
+void io_error(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vfprintf(io_context()->err, format, args);
+    va_end(args);
+}
+
+// *********IMPLEMENTATION OF THROTTLE API*********
+// glibc has no header for ioprio, values are from linux/ioprio.h
+#define IOPRIO_WHO_PROCESS 1
+#define IOPRIO_IDLE ((3 << 13) | 7)
+
+const off_t throttle_drop_cache_step = 1 << 23;
+
+void token_bucket_init(TokenBucket* bucket, uint64 rate)
+{
+    // allow burst of 100 ms, so short stalls are made up
+    bucket->rate = rate;
+    bucket->burst = rate / 10.0;
+    bucket->tokens = 0;
+    clock_gettime(CLOCK_MONOTONIC, &bucket->last);
+}
+
+uint64 token_bucket_delay(TokenBucket* bucket, uint64 bytes, const struct timespec* now)
+{
+    if(bucket->rate == 0)
+        return 0;
+
+    const double elapsed = (now->tv_sec - bucket->last.tv_sec) +
+                           (now->tv_nsec - bucket->last.tv_nsec) / 1e9;
+
+    bucket->last = *now;
+    bucket->tokens += elapsed * bucket->rate;
+    if(bucket->tokens > bucket->burst)
+        bucket->tokens = bucket->burst;
+
+    // tokens refilled while caller sleeps are added by next call
+    bucket->tokens -= bytes;
+    return (bucket->tokens < 0) ?(uint64)(-bucket->tokens / bucket->rate * 1e9) :0;
+}
+
+void token_bucket_consume(TokenBucket* bucket, uint64 bytes)
+{
+    struct timespec now;
+
+    if(bucket->rate == 0)
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const uint64 delay = token_bucket_delay(bucket, bytes, &now);
+
+    if(delay) {
+        struct timespec wait = {delay / 1000000000, delay % 1000000000};
+        while(nanosleep(&wait, &wait) != 0 && errno == EINTR)
+            ;
+    }
+}
+
+ssize_t throttled_read(void* cookie, char* buffer, size_t size)
+{
+    ThrottledStream* stream = (ThrottledStream*)cookie;
+
+    // read at most 100 ms worth of data, so limit is smooth
+    if(stream->bucket.rate && size > stream->bucket.rate / 10 + 1)
+        size = stream->bucket.rate / 10 + 1;
+
+    ssize_t n = (stream->fd >= 0) ?read(stream->fd, buffer, size)
+                                  :(ssize_t)fread(buffer, 1, size, stream->file);
+    if(n <= 0)
+        return n;
+
+    token_bucket_consume(&stream->bucket, n);
+    stream->position += n;
+
+    if(stream->drop_cache && stream->position - stream->dropped >= throttle_drop_cache_step) {
+        posix_fadvise(stream->fd, stream->dropped, stream->position - stream->dropped,
+                      POSIX_FADV_DONTNEED);
+        stream->dropped = stream->position;
+    }
+
+    return n;
+}
+
+int throttled_seek(void* cookie, off64_t* offset, int whence)
+{
+    ThrottledStream* stream = (ThrottledStream*)cookie;
+    off_t position = -1;
+
+    if(stream->fd >= 0)
+        position = lseek(stream->fd, *offset, whence);
+    else if(fseeko(stream->file, *offset, whence) == 0)
+        position = ftello(stream->file);
+
+    if(position < 0)
+        return -1;
+
+    // cache behind new position is dropped only from there
+    stream->position = position;
+    stream->dropped = position;
+    *offset = position;
+    return 0;
+}
+
+ssize_t throttled_write(void* cookie, const char* buffer, size_t size)
+{
+    ThrottledStream* stream = (ThrottledStream*)cookie;
+
+    token_bucket_consume(&stream->bucket, size);
+    if(fwrite(buffer, 1, size, stream->file) != size)
+        return -1;
+    return size;
+}
+
+bool throttle_begin(Throttle* throttle, uint64 input_rate, uint64 output_rate, bool background)
+{
+    cookie_io_functions_t in_functions = {throttled_read, NULL, throttled_seek, NULL};
+    cookie_io_functions_t out_functions = {NULL, throttled_write, NULL, NULL};
+
+    throttle->previous = io_context();
+    throttle->io = *throttle->previous;
+    throttle->previous_ioprio = -1;
+
+    if(input_rate || background) {
+        ThrottledStream* in = &throttle->in;
+
+        token_bucket_init(&in->bucket, input_rate);
+        in->file = throttle->previous->in;
+        in->fd = throttle->previous->in_fd;
+        in->drop_cache = background && in->fd >= 0;
+        in->position = (in->fd >= 0) ?lseek(in->fd, 0, SEEK_CUR) :0;
+        if(in->position < 0)
+            in->drop_cache = false;
+        in->dropped = in->position;
+
+        if(in->drop_cache)
+            posix_fadvise(in->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+        // sampling and ELF still seek in regular file, reads are limited
+        struct stat st;
+        if(in->fd >= 0 && fstat(in->fd, &st) == 0 && S_ISREG(st.st_mode))
+            throttle->io.in_size = st.st_size;
+
+        throttle->io.in = fopencookie(in, "r", in_functions);
+        throttle->io.in_fd = -1;
+        if(throttle->io.in == NULL)
+            return false;
+    }
+
+    if(output_rate) {
+        token_bucket_init(&throttle->out.bucket, output_rate);
+        throttle->out.file = throttle->previous->out;
+        throttle->out.fd = -1;
+        throttle->out.drop_cache = false;
+
+        throttle->io.out = fopencookie(&throttle->out, "w", out_functions);
+        throttle->io.out_fd = -1;
+        if(throttle->io.out == NULL) {
+            if(throttle->io.in != throttle->previous->in)
+                fclose(throttle->io.in);
+            return false;
+        }
+    }
+
+    // idle class, disk is used only when nobody else needs it, who 0 means calling thread (gettid)
+    if(background) {
+        throttle->previous_ioprio = syscall(SYS_ioprio_get, IOPRIO_WHO_PROCESS, 0);
+        if(throttle->previous_ioprio >= 0 &&
+                syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, IOPRIO_IDLE) != 0)
+            throttle->previous_ioprio = -1;
+    }
+
+    io_set_context(&throttle->io);
+    return true;
+}
+
+void throttle_end(Throttle* throttle)
+{
+    if(throttle->io.in != throttle->previous->in) {
+        fclose(throttle->io.in);
+
+        ThrottledStream* in = &throttle->in;
+        if(in->drop_cache && in->position > in->dropped)
+            posix_fadvise(in->fd, in->dropped, in->position - in->dropped, POSIX_FADV_DONTNEED);
+    }
+
+    if(throttle->io.out != throttle->previous->out) {
+        fclose(throttle->io.out);
+        fflush(throttle->previous->out);
+    }
+
+    if(throttle->previous_ioprio >= 0)
+        syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, throttle->previous_ioprio);
+
+    io_set_context(throttle->previous);
+}
+
+// *********IMPLEMENTATION OF DIRECT API*********
+void* direct_prefetch(void* arg)
+{
+    DirectReader* reader = (DirectReader*)arg;
+
+    while(true) {
+        pthread_mutex_lock(&reader->lock);
+        while(reader->count == DIRECT_BUFFERS_COUNT && !reader->stop)
+            pthread_cond_wait(&reader->freed, &reader->lock);
+
+        if(reader->stop) {
+            pthread_mutex_unlock(&reader->lock);
+            break;
+        }
+
+        DirectBuffer* buffer = &reader->buffers[(reader->head + reader->count) % DIRECT_BUFFERS_COUNT];
+        pthread_mutex_unlock(&reader->lock);
+
+        ssize_t n = pread(reader->fd, buffer->data, direct_buffer_size, reader->read_offset);
+
+        // filesystem accepted O_DIRECT in open, but not in read
+        if(n < 0 && errno == EINVAL && reader->fd != reader->fallback_fd) {
+            close(reader->fd);
+            reader->fd = reader->fallback_fd;
+            continue;
+        }
+        if(n < 0 && errno == EINTR)
+            continue;
+
+        pthread_mutex_lock(&reader->lock);
+        if(n < 0)
+            reader->error = errno;
+        else if(n > 0) {
+            buffer->offset = reader->read_offset;
+            buffer->len = n;
+            reader->read_offset += n;
+            ++reader->count;
+        }
+
+        // short read means end of file (tail is not aligned)
+        reader->eof = n < (ssize_t)direct_buffer_size;
+        pthread_cond_signal(&reader->filled);
+        pthread_mutex_unlock(&reader->lock);
+
+        if(reader->eof)
+            break;
+    }
+
+    return NULL;
+}
+
+static void direct_stop(DirectReader* reader)
+{
+    if(!reader->running)
+        return;
+
+    pthread_mutex_lock(&reader->lock);
+    reader->stop = true;
+    pthread_cond_signal(&reader->freed);
+    pthread_mutex_unlock(&reader->lock);
+
+    pthread_join(reader->thread, NULL);
+    reader->running = false;
+}
+
+ssize_t direct_read(void* cookie, char* buffer, size_t size)
+{
+    DirectReader* reader = (DirectReader*)cookie;
+
+    // start lazily, so seek before first read does not waste reads
+    if(!reader->running && !reader->eof) {
+        reader->head = 0;
+        reader->count = 0;
+        reader->stop = false;
+        reader->error = 0;
+        reader->read_offset = reader->position - reader->position % direct_alignment;
+        reader->running = pthread_create(&reader->thread, NULL, direct_prefetch, reader) == 0;
+
+        if(!reader->running) {
+            errno = EAGAIN;
+            return -1;
+        }
+    }
+
+    while(true) {
+        pthread_mutex_lock(&reader->lock);
+        while(reader->count == 0 && !reader->eof && reader->error == 0)
+            pthread_cond_wait(&reader->filled, &reader->lock);
+
+        if(reader->count == 0) {
+            const int error = reader->error;
+            pthread_mutex_unlock(&reader->lock);
+            errno = error;
+            return (error) ?-1 :0;
+        }
+
+        DirectBuffer* current = &reader->buffers[reader->head];
+        pthread_mutex_unlock(&reader->lock);
+
+        // first buffer starts at aligned offset before position
+        const uint64 start = reader->position - current->offset;
+        const uint64 available = (current->len > start) ?current->len - start :0;
+        const uint64 n = (available < size) ?available :size;
+
+        memcpy(buffer, current->data + start, n);
+        reader->position += n;
+
+        if(n == available) {
+            pthread_mutex_lock(&reader->lock);
+            reader->head = (reader->head + 1) % DIRECT_BUFFERS_COUNT;
+            --reader->count;
+            pthread_cond_signal(&reader->freed);
+            pthread_mutex_unlock(&reader->lock);
+        }
+
+        if(n)
+            return n;
+    }
+}
+
+int direct_seek(void* cookie, off64_t* offset, int whence)
+{
+    DirectReader* reader = (DirectReader*)cookie;
+    struct stat st;
+    off64_t position = *offset;
+
+    if(whence == SEEK_CUR)
+        position += reader->position;
+    else if(whence == SEEK_END) {
+        if(fstat(reader->fallback_fd, &st) != 0)
+            return -1;
+        position += st.st_size;
+    }
+
+    if(position < 0)
+        return -1;
+
+    // only telling position does not restart prefetching
+    if((uint64)position != reader->position) {
+        direct_stop(reader);
+        reader->position = position;
+        reader->eof = false;
+    }
+
+    *offset = position;
+    return 0;
+}
+
+bool direct_begin(DirectReader* reader)
+{
+    cookie_io_functions_t functions = {direct_read, NULL, direct_seek, NULL};
+    IoContext* previous = io_context();
+    struct stat st;
+    char path[32];
+
+    if(previous->in_fd < 0 || fstat(previous->in_fd, &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+
+    // new open file description, because O_DIRECT must not leak to shell's descriptor
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", previous->in_fd);
+    reader->fallback_fd = previous->in_fd;
+    reader->fd = open(path, O_RDONLY | O_DIRECT | O_CLOEXEC);
+    if(reader->fd < 0)
+        reader->fd = reader->fallback_fd;
+
+    const off_t position = lseek(previous->in_fd, 0, SEEK_CUR);
+    reader->position = (position > 0) ?position :0;
+    reader->running = false;
+    reader->eof = false;
+    reader->previous = previous;
+
+    for(int i = 0; i < DIRECT_BUFFERS_COUNT; ++i) {
+        if(posix_memalign((void**)&reader->buffers[i].data, direct_alignment, direct_buffer_size) != 0) {
+            // without buffers input is read as usual
+            for(int j = 0; j < i; ++j)
+                free(reader->buffers[j].data);
+            if(reader->fd != reader->fallback_fd)
+                close(reader->fd);
+            return false;
+        }
+    }
+
+    pthread_mutex_init(&reader->lock, NULL);
+    pthread_cond_init(&reader->filled, NULL);
+    pthread_cond_init(&reader->freed, NULL);
+
+    reader->io = *previous;
+    reader->io.in = fopencookie(reader, "r", functions);
+    reader->io.in_fd = -1;
+    reader->io.in_size = st.st_size;
+
+    if(reader->io.in == NULL) {
+        direct_end(reader);
+        return false;
+    }
+
+    io_set_context(&reader->io);
+    return true;
+}
+
+void direct_end(DirectReader* reader)
+{
+    off_t position = reader->position;
+
+    // leave shared descriptor where reader ended, not where stream buffer ended
+    if(reader->io.in != NULL && reader->io.in != reader->previous->in) {
+        position = ftello(reader->io.in);
+        fclose(reader->io.in);
+    }
+    direct_stop(reader);
+
+    if(position >= 0)
+        lseek(reader->fallback_fd, position, SEEK_SET);
+    if(reader->fd != reader->fallback_fd)
+        close(reader->fd);
+
+    for(int i = 0; i < DIRECT_BUFFERS_COUNT; ++i)
+        free(reader->buffers[i].data);
+
+    pthread_mutex_destroy(&reader->lock);
+    pthread_cond_destroy(&reader->filled);
+    pthread_cond_destroy(&reader->freed);
+    io_set_context(reader->previous);
+}
+
+// *********IMPLEMENTATION OF INPUT API*********
+bool input_map(InputMap* m)
+{
+    struct stat st;
+    IoContext* io = io_context();
+
+    m->data = NULL;
+    m->size = 0;
+    m->mapping = NULL;
+    m->mapping_size = 0;
+
+    if(io->in_fd >= 0 && fstat(io->in_fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        off_t position = lseek(io->in_fd, 0, SEEK_CUR);
+        if(position < 0)
+            position = 0;
+
+        if(st.st_size <= position)      // nothing to map
+            return true;
+
+        void* mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, io->in_fd, 0);
+        if(mapping != MAP_FAILED) {
+            madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+            m->mapping = mapping;
+            m->mapping_size = st.st_size;
+            m->data = m->mapping + position;
+            m->size = st.st_size - position;
+            return true;
+        }
+    }
+
+    // input is not mappable, so read it into heap
+    uint64 capacity = 1 << 16;
+    uint8* buffer = malloc(capacity);
+    ssize_t n;
+
+    if(buffer == NULL)
+        return false;
+
+    // without descriptor (e.g. inline daemon payload) read through stream
+    while((n = (io->in_fd >= 0) ?read(io->in_fd, buffer + m->size, capacity - m->size)
+                                :(ssize_t)fread(buffer + m->size, 1, capacity - m->size, io->in)) > 0) {
+        m->size += n;
+
+        if(m->size == capacity) {
+            uint8* bigger = realloc(buffer, capacity *= 2);
+            if(bigger == NULL) {
+                free(buffer);
+                return false;
+            }
+            buffer = bigger;
+        }
+    }
+
+    m->data = buffer;
+    if(n < 0) {
+        input_unmap(m);
+        return false;
+    }
+
+    return true;
+}
+
+void input_unmap(InputMap* m)
+{
+    if(m->mapping != NULL)
+        munmap(m->mapping, m->mapping_size);
+    else
+        free((void*)m->data);
+
+    m->data = NULL;
+    m->mapping = NULL;
+    m->size = 0;
+}
+
+// *********IMPLEMENTATION OF OUTPUT API*********
+off_t output_offset(int fd)
+{
+    struct stat st;
+    int fd_flags = fcntl(fd, F_GETFL);
+
+    // pwrite ignores offset for O_APPEND
+    if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || fd_flags < 0 || (fd_flags & O_APPEND))
+        return -1;
+
+    return lseek(fd, 0, SEEK_CUR);
+}
+
+bool output_write(int fd, const void* buffer, uint64 len, off_t offset)
+{
+    const uint8* data = (const uint8*)buffer;
+
+    while(len) {
+        ssize_t written = (offset < 0) ?write(fd, data, len) :pwrite(fd, data, len, offset);
+
+        if(written < 0 && errno == EINTR)
+            continue;
+        if(written <= 0)
+            return false;
+
+        data += written;
+        len -= written;
+        if(offset >= 0)
+            offset += written;
+    }
+
+    return true;
+}
+
+// *********IMPLEMENTATION OF THREAD API*********
+unsigned int threads_count(int requested)
+{
+    if(requested > 0)
+        return requested;
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return (cpus > 0) ?(unsigned int)cpus :1;
+}
+
+void parallel_run(void* (*worker)(void*), void* items, size_t item_size, unsigned int count)
+{
+    uint8* item = (uint8*)items;
+    pthread_t workers[count];
+    bool worker_started[count];
+
+    for(unsigned int i = 1; i < count; ++i)
+        worker_started[i] = pthread_create(&workers[i], NULL, worker, item + i * item_size) == 0;
+
+    if(count)
+        worker(item);
+
+    // if thread can not be created, process its item here
+    for(unsigned int i = 1; i < count; ++i) {
+        if(worker_started[i])
+            pthread_join(workers[i], NULL);
+        else
+            worker(item + i * item_size);
+    }
+}
+
+// *********IMPLEMENTATION OF SPLIT API*********
+bool split_is_printable(int c)
+{
+    return isprint(c) || isblank(c);
+}
+
+bool split_run_append(SplitRunList* list, uint64 offset, uint64 len)
+{
+    if(list->count == list->capacity) {
+        const uint64 capacity = (list->capacity) ?list->capacity * 2 :64;
+        SplitRun* grown = realloc(list->items, capacity * sizeof(SplitRun));
+
+        if(grown == NULL) {
+            list->failed = true;
+            return false;
+        }
+        list->items = grown;
+        list->capacity = capacity;
+    }
+
+    list->items[list->count].offset = offset;
+    list->items[list->count].len = len;
+    ++list->count;
+    return true;
+}
+
+void* split_scan_chunk(void* arg)
+{
+    SplitChunk* chunk = (SplitChunk*)arg;
+    const uint8* data = chunk->data;
+    uint64 run_start = chunk->start;
+    bool in_run = false;
+
+    for(uint64 i = chunk->start; i < chunk->end; ++i) {
+        if(split_is_printable(data[i])) {
+            if(!in_run)
+                run_start = i;
+            in_run = true;
+        }
+
+        else if(in_run) {
+            if(i - run_start >= chunk->word_size || run_start == chunk->start)
+                split_run_append(&chunk->runs[RUN_ASCII], run_start, i - run_start);
+            in_run = false;
+        }
+    }
+
+    // word may continue in next chunk
+    if(in_run)
+        split_run_append(&chunk->runs[RUN_ASCII], run_start, chunk->end - run_start);
+
+    for(int parity = 0; parity < 2 && chunk->utf16; ++parity) {
+        SplitRunList* list = &chunk->runs[RUN_UTF16_EVEN + parity];
+        const uint64 first = chunk->start + (chunk->start + parity) % 2;
+        uint64 len = 0;
+
+        // unit is printable character followed by '\0', second byte can be in next chunk
+        for(uint64 i = first; i < chunk->end; i += 2) {
+            if(i + 1 < chunk->size && data[i + 1] == '\0' && split_is_printable(data[i])) {
+                if(len++ == 0)
+                    run_start = i;
+            }
+
+            else if(len) {
+                if(len >= chunk->word_size || run_start == first)
+                    split_run_append(list, run_start, len);
+                len = 0;
+            }
+        }
+
+        if(len)
+            split_run_append(list, run_start, len);
+    }
+
+    return NULL;
+}
+
+void split_stitch(SplitChunk* chunks, unsigned int chunks_count, RunKind kind,
+                  unsigned int word_size, SplitRunList* result)
+{
+    const uint64 unit_size = (kind == RUN_ASCII) ?1 :2;
+    bool pending = false;
+    SplitRun run = {0, 0};
+
+    for(unsigned int c = 0; c < chunks_count; ++c) {
+        const SplitRunList* list = &chunks[c].runs[kind];
+
+        for(uint64 i = 0; i < list->count; ++i) {
+            // runs inside one chunk are never adjacent, so adjacent runs were cut by boundary
+            if(pending && run.offset + run.len * unit_size == list->items[i].offset) {
+                run.len += list->items[i].len;
+                continue;
+            }
+
+            if(pending && run.len >= word_size)
+                split_run_append(result, run.offset, run.len);
+            run = list->items[i];
+            pending = true;
+        }
+    }
+
+    if(pending && run.len >= word_size)
+        split_run_append(result, run.offset, run.len);
+}
+
+// *********IMPLEMENTATION OF REVERSE API*********
+static uint8 hex_table[256];
+static pthread_once_t hex_table_once = PTHREAD_ONCE_INIT;
+
+static void hex_table_init()
+{
+    for(int c = 0; c < 256; ++c)
+        hex_table[c] = hex_classify(c);
+}
+
+void* reverse_count_chunk(void* arg)
+{
+    ReverseChunk* chunk = (ReverseChunk*)arg;
+
+    chunk->digits = 0;
+    chunk->last_digit = -1;
+    chunk->invalid = chunk->end;
+
+    for(uint64 i = chunk->start; i < chunk->end; ++i) {
+        const uint8 value = hex_table[chunk->data[i]];
+
+        if(value < HEX_SPACE) {
+            ++chunk->digits;
+            chunk->last_digit = value;
+        }
+        else if(value == HEX_INVALID) {
+            chunk->invalid = i;
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+void* reverse_decode_chunk(void* arg)
+{
+    ReverseChunk* chunk = (ReverseChunk*)arg;
+    uint8* output = chunk->output;
+    int high = chunk->carry;
+
+    for(uint64 i = chunk->start; i < chunk->end; ++i) {
+        const uint8 value = hex_table[chunk->data[i]];
+
+        if(value >= HEX_SPACE)
+            continue;
+
+        if(high < 0)
+            high = value;
+        else {
+            *output++ = (high << 4) | value;
+            high = -1;
+        }
+    }
+
+    chunk->output_len = output - chunk->output;
+    chunk->failed = chunk->fd >= 0 && !output_write(chunk->fd, chunk->output, chunk->output_len,
+                                                    chunk->output_offset);
+
+    return NULL;
+}
+
+// *********IMPLEMENTATION OF DAEMON API*********
+bool socket_send_all(int socket, const void* buffer, uint64 len)
+{
+    const uint8* data = (const uint8*)buffer;
+
+    while(len) {
+        // MSG_NOSIGNAL, because client leaving must not kill daemon
+        ssize_t sent = send(socket, data, len, MSG_NOSIGNAL);
+
+        if(sent < 0 && errno == EINTR)
+            continue;
+        if(sent <= 0)
+            return false;
+
+        data += sent;
+        len -= sent;
+    }
+
+    return true;
+}
+
+bool socket_recv_all(int socket, void* buffer, uint64 len)
+{
+    uint8* data = (uint8*)buffer;
+
+    while(len) {
+        ssize_t received = recv(socket, data, len, 0);
+
+        if(received < 0 && errno == EINTR)
+            continue;
+        if(received <= 0)
+            return false;
+
+        data += received;
+        len -= received;
+    }
+
+    return true;
+}
+
+bool daemon_send_frame(int socket, DaemonFrameType type, const void* data, uint32 len)
+{
+    DaemonFrame frame = {type, len};
+
+    return socket_send_all(socket, &frame, sizeof(frame)) && socket_send_all(socket, data, len);
+}
+
+bool daemon_send_request(int socket, const DaemonRequest* request, int fd)
+{
+    struct iovec iov = {(void*)request, sizeof(DaemonRequest)};
+    struct msghdr message = {0};
+    union
+    {
+        struct cmsghdr header;      // for alignment
+        char buffer[CMSG_SPACE(sizeof(int))];
+    } control;
+
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+
+    if(fd >= 0) {
+        message.msg_control = control.buffer;
+        message.msg_controllen = sizeof(control.buffer);
+
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        *(int*)CMSG_DATA(cmsg) = fd;
+    }
+
+    ssize_t sent;
+    while((sent = sendmsg(socket, &message, MSG_NOSIGNAL)) < 0 && errno == EINTR)
+        ;
+
+    if(sent <= 0)
+        return false;
+
+    // descriptor went with first byte, rest is plain data
+    return socket_send_all(socket, (const uint8*)request + sent, sizeof(DaemonRequest) - sent);
+}
+
+bool daemon_recv_request(int socket, DaemonRequest* request, int* fd)
+{
+    struct iovec iov = {request, sizeof(DaemonRequest)};
+    struct msghdr message = {0};
+    union
+    {
+        struct cmsghdr header;
+        char buffer[CMSG_SPACE(sizeof(int) * 4)];
+    } control;
+
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buffer;
+    message.msg_controllen = sizeof(control.buffer);
+    *fd = -1;
+
+    ssize_t received;
+    while((received = recvmsg(socket, &message, MSG_CMSG_CLOEXEC)) < 0 && errno == EINTR)
+        ;
+
+    if(received <= 0)
+        return false;
+
+    for(struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != NULL; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+        if(cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+            continue;
+
+        const int* fds = (const int*)CMSG_DATA(cmsg);
+        const int fds_count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+
+        // only one descriptor is expected, close the rest
+        for(int i = 0; i < fds_count; ++i) {
+            if(*fd < 0)
+                *fd = fds[i];
+            else
+                close(fds[i]);
+        }
+    }
+
+    return socket_recv_all(socket, (uint8*)request + received, sizeof(DaemonRequest) - received);
+}
+
+bool daemon_reserve(void** buffer, uint64* capacity, uint64 size)
+{
+    if(size <= *capacity)
+        return true;
+
+    void* bigger = realloc(*buffer, size);
+    if(bigger == NULL)
+        return false;
+
+    *buffer = bigger;
+    *capacity = size;
+    return true;
+}
+
+ssize_t daemon_stream_write(void* cookie, const char* buffer, size_t size)
+{
+    DaemonStream* stream = (DaemonStream*)cookie;
+
+    if(!daemon_send_frame(stream->socket, stream->type, buffer, size))
+        return -1;
+    return size;
+}
+
+void daemon_handle(DaemonWorker* worker, int client)
+{
+    DaemonRequest request;
+    int fd = -1;
+
+    if(!daemon_recv_request(client, &request, &fd) || request.magic != DAEMON_MAGIC ||
+            request.argc > daemon_max_args || request.args_len > daemon_max_args_len ||
+            request.payload_len > daemon_max_payload_len ||
+            !daemon_reserve((void**)&worker->args, &worker->args_capacity, request.args_len + 1) ||
+            !daemon_reserve((void**)&worker->payload, &worker->payload_capacity, request.payload_len + 1) ||
+            !socket_recv_all(client, worker->args, request.args_len) ||
+            !socket_recv_all(client, worker->payload, request.payload_len)) {
+        if(fd >= 0)
+            close(fd);
+        return;
+    }
+
+    worker->args[request.args_len] = '\0';
+    worker->payload[request.payload_len] = '\0';
+
+    // rebuild argv, arguments are '\0' terminated
+    const char* argv[daemon_max_args + 1];
+    unsigned int argc = 1;
+    bool valid = true;
+    argv[0] = "proj1";
+
+    for(uint64 i = 0; i < request.args_len; i += string_len(worker->args + i) + 1) {
+        if(!(valid = argc <= request.argc))
+            break;
+        argv[argc++] = worker->args + i;
+    }
+    valid = valid && argc == request.argc + 1;
+
+    // daemon must not start another daemon or client
+    for(unsigned int i = 1; i < argc && valid; ++i) {
+        const Actions action = distinguish_action(argv[i]);
+        valid = action == UNDEFINED || (action & (DAEMON | CLIENT)) == 0;
+    }
+
+    DaemonStream out_stream = {client, DAEMON_FRAME_OUTPUT};
+    DaemonStream err_stream = {client, DAEMON_FRAME_ERROR};
+    cookie_io_functions_t functions = {NULL, daemon_stream_write, NULL, NULL};
+    IoContext io = {NULL, fopencookie(&out_stream, "w", functions),
+                    fopencookie(&err_stream, "w", functions), -1, -1, -1};
+    uint32 status = EXIT_FAILURE;
+
+    if(request.input == DAEMON_INPUT_PATH && fd < 0)
+        fd = open((const char*)worker->payload, O_RDONLY | O_CLOEXEC);
+
+    if(request.input == DAEMON_INPUT_INLINE)
+        io.in = (request.payload_len) ?fmemopen(worker->payload, request.payload_len, "r")
+                                      :fopen("/dev/null", "r");
+    else if(fd >= 0 && (io.in = fdopen(fd, "r")) != NULL)
+        io.in_fd = fd;
+
+    if(io.in == NULL && fd >= 0)
+        close(fd);
+
+    if(io.out != NULL && io.err != NULL) {
+        setvbuf(io.out, worker->output_buffer, _IOFBF, daemon_buffer_size);
+
+        if(!valid)
+            fprintf(io.err, "ERROR: Invalid request\n");
+        else if(io.in == NULL)
+            fprintf(io.err, "ERROR: Unable to open input\n");
+        else {
+            io_set_context(&io);
+            status = run_arguments(argc, argv);
+            io_set_context(NULL);
+        }
+    }
+
+    if(io.in != NULL)
+        fclose(io.in);
+    if(io.out != NULL)
+        fclose(io.out);
+    if(io.err != NULL)
+        fclose(io.err);
+
+    daemon_send_frame(client, DAEMON_FRAME_EXIT, &status, sizeof(status));
+}
+
+void* daemon_worker(void* arg)
+{
+    DaemonWorker* worker = (DaemonWorker*)arg;
+
+    while(true) {
+        int client = accept4(worker->listen_socket, NULL, NULL, SOCK_CLOEXEC);
+
+        if(client < 0) {
+            if(errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break;
+        }
+
+        daemon_handle(worker, client);
+        close(client);
+    }
+
+    return NULL;
+}
+
+int daemon_serve(const char* path, int threads)
+{
+    struct sockaddr_un address = {0};
+    struct stat st;
+
+    if(string_len(path) >= sizeof(address.sun_path)) {
+        io_error("ERROR: Socket path is too long\n");
+        return EXIT_FAILURE;
+    }
+
+    address.sun_family = AF_UNIX;
+    for(unsigned int i = 0; path[i]; ++i)
+        address.sun_path[i] = path[i];
+
+    // remove socket left by previous daemon
+    if(lstat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+        unlink(path);
+
+    // only owner can send requests, daemon reads files with its rights
+    const mode_t previous_mask = umask(0077);
+    int listen_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    const bool listening = listen_socket >= 0 &&
+                           bind(listen_socket, (struct sockaddr*)&address, sizeof(address)) == 0 &&
+                           listen(listen_socket, SOMAXCONN) == 0;
+    umask(previous_mask);
+
+    if(!listening) {
+        io_error("ERROR: Unable to listen on %s\n", path);
+        if(listen_socket >= 0)
+            close(listen_socket);
+        return EXIT_FAILURE;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    const unsigned int workers_count = threads_count(threads);
+    DaemonWorker* workers = calloc(workers_count, sizeof(DaemonWorker));
+
+    bool allocated = workers != NULL;
+
+    for(unsigned int i = 0; allocated && i < workers_count; ++i) {
+        workers[i].listen_socket = listen_socket;
+        workers[i].output_buffer = malloc(daemon_buffer_size);
+        allocated = workers[i].output_buffer != NULL;
+    }
+
+    if(allocated)
+        parallel_run(daemon_worker, workers, sizeof(DaemonWorker), workers_count);
+    else
+        io_error("ERROR: Out of memory\n");
+
+    for(unsigned int i = 0; workers != NULL && i < workers_count; ++i) {
+        free(workers[i].args);
+        free(workers[i].payload);
+        free(workers[i].output_buffer);
+    }
+    free(workers);
+    close(listen_socket);
+    unlink(path);
+
+    return EXIT_FAILURE;
+}
+
+bool daemon_client(const char* path, int argc, const char* argv[], int skip, int* status)
+{
+    struct sockaddr_un address = {0};
+
+    if(string_len(path) >= sizeof(address.sun_path))
+        return false;
+
+    address.sun_family = AF_UNIX;
+    for(unsigned int i = 0; path[i]; ++i)
+        address.sun_path[i] = path[i];
+
+    int client = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(client < 0)
+        return false;
+
+    if(connect(client, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        close(client);
+        return false;
+    }
+
+    // pack arguments without program name and -C PATH
+    DaemonRequest request = {DAEMON_MAGIC, DAEMON_INPUT_FD, 0, 0, 0};
+    for(int i = 1; i < argc; ++i) {
+        if(i != skip && i != skip - 1) {
+            ++request.argc;
+            request.args_len += string_len(argv[i]) + 1;
+        }
+    }
+
+    char args[request.args_len + 1];
+    char* position = args;
+    for(int i = 1; i < argc; ++i) {
+        if(i == skip || i == skip - 1)
+            continue;
+
+        for(const char* c = argv[i]; *c; ++c)
+            *position++ = *c;
+        *position++ = '\0';
+    }
+
+    *status = EXIT_FAILURE;
+
+    if(!daemon_send_request(client, &request, STDIN_FILENO) ||
+            !socket_send_all(client, args, request.args_len)) {
+        close(client);
+        return true;
+    }
+
+    DaemonFrame frame;
+    uint8 buffer[1 << 16];
+
+    while(socket_recv_all(client, &frame, sizeof(frame))) {
+        if(frame.type == DAEMON_FRAME_EXIT) {
+            uint32 exit_status;
+            if(frame.len == sizeof(exit_status) && socket_recv_all(client, &exit_status, sizeof(exit_status)))
+                *status = exit_status;
+            break;
+        }
+
+        const int target = (frame.type == DAEMON_FRAME_OUTPUT) ?STDOUT_FILENO :STDERR_FILENO;
+
+        while(frame.len) {
+            const uint32 len = (frame.len > sizeof(buffer)) ?sizeof(buffer) :frame.len;
+
+            if(!socket_recv_all(client, buffer, len) || !output_write(target, buffer, len, -1)) {
+                close(client);
+                return true;
+            }
+            frame.len -= len;
+        }
+    }
+
+    close(client);
+    return true;
+}
+
+// *********IMPLEMENTATION OF CHECKSUM API*********
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3 0x165667B19E3779F9ULL
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ULL
+
+static uint32 crc32c_table[256];
+static pthread_once_t crc32c_table_once = PTHREAD_ONCE_INIT;
+
+static void crc32c_table_init()
+{
+    for(uint32 i = 0; i < 256; ++i) {
+        uint32 crc = i;
+        for(int bit = 0; bit < 8; ++bit)
+            crc = (crc >> 1) ^ ((crc & 1) ?0x82F63B78u :0);
+        crc32c_table[i] = crc;
+    }
+}
+
+static uint64 read_le64(const uint8* data)
+{
+    uint64 value;
+    memcpy(&value, data, sizeof(value));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+static uint32 read_le32(const uint8* data)
+{
+    uint32 value;
+    memcpy(&value, data, sizeof(value));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap32(value);
+#endif
+    return value;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse4.2")))
+static uint32 crc32c_sse42(uint32 crc, const uint8* data, uint64 len)
+{
+#if defined(__x86_64__)
+    uint64 crc64 = crc;
+    for(; len >= 8; len -= 8, data += 8)
+        crc64 = _mm_crc32_u64(crc64, read_le64(data));
+    crc = (uint32)crc64;
+#endif
+
+    while(len--)
+        crc = _mm_crc32_u8(crc, *data++);
+    return crc;
+}
+#endif
+
+uint32 crc32c_update(uint32 crc, const uint8* data, uint64 len)
+{
+    crc = ~crc;
+
+#if defined(__x86_64__) || defined(__i386__)
+    if(__builtin_cpu_supports("sse4.2"))
+        return ~crc32c_sse42(crc, data, len);
+#endif
+
+    pthread_once(&crc32c_table_once, crc32c_table_init);
+    while(len--)
+        crc = (crc >> 8) ^ crc32c_table[(crc ^ *data++) & 0xff];
+
+    return ~crc;
+}
+
+static uint64 xxh64_rotl(uint64 x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static uint64 xxh64_round(uint64 acc, uint64 input)
+{
+    acc += input * XXH_PRIME64_2;
+    return xxh64_rotl(acc, 31) * XXH_PRIME64_1;
+}
+
+static uint64 xxh64_merge(uint64 acc, uint64 value)
+{
+    acc ^= xxh64_round(0, value);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+void checksum_reset(Checksum* sum, ChecksumKind kind)
+{
+    sum->kind = kind;
+    sum->len = 0;
+    sum->crc = 0;
+    sum->stripe_len = 0;
+    sum->acc[0] = XXH_PRIME64_1 + XXH_PRIME64_2;
+    sum->acc[1] = XXH_PRIME64_2;
+    sum->acc[2] = 0;
+    sum->acc[3] = -XXH_PRIME64_1;
+}
+
+void checksum_update(Checksum* sum, const uint8* data, uint64 len)
+{
+    sum->len += len;
+
+    if(sum->kind == CHECKSUM_CRC32C) {
+        sum->crc = crc32c_update(sum->crc, data, len);
+        return;
+    }
+
+    // fill incomplete stripe first
+    while(sum->stripe_len && len) {
+        sum->stripe[sum->stripe_len++] = *data++;
+        --len;
+
+        if(sum->stripe_len == 32) {
+            for(int i = 0; i < 4; ++i)
+                sum->acc[i] = xxh64_round(sum->acc[i], read_le64(sum->stripe + 8 * i));
+            sum->stripe_len = 0;
+        }
+    }
+
+    for(; len >= 32; len -= 32, data += 32) {
+        for(int i = 0; i < 4; ++i)
+            sum->acc[i] = xxh64_round(sum->acc[i], read_le64(data + 8 * i));
+    }
+
+    while(len--)
+        sum->stripe[sum->stripe_len++] = *data++;
+}
+
+uint64 checksum_value(const Checksum* sum)
+{
+    if(sum->kind == CHECKSUM_CRC32C)
+        return sum->crc;
+
+    uint64 h;
+    const uint8* p = sum->stripe;
+    uint32 rest = sum->stripe_len;
+
+    if(sum->len >= 32) {
+        h = xxh64_rotl(sum->acc[0], 1) + xxh64_rotl(sum->acc[1], 7) +
+            xxh64_rotl(sum->acc[2], 12) + xxh64_rotl(sum->acc[3], 18);
+        for(int i = 0; i < 4; ++i)
+            h = xxh64_merge(h, sum->acc[i]);
+    }
+    else
+        h = XXH_PRIME64_5;
+
+    h += sum->len;
+
+    for(; rest >= 8; rest -= 8, p += 8) {
+        h ^= xxh64_round(0, read_le64(p));
+        h = xxh64_rotl(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+    }
+
+    if(rest >= 4) {
+        h ^= (uint64)read_le32(p) * XXH_PRIME64_1;
+        h = xxh64_rotl(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        rest -= 4;
+        p += 4;
+    }
+
+    while(rest--) {
+        h ^= (*p++) * XXH_PRIME64_5;
+        h = xxh64_rotl(h, 11) * XXH_PRIME64_1;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+const char* checksum_name(ChecksumKind kind)
+{
+    return (kind == CHECKSUM_XXH64) ?"xxh64" :"crc32c";
+}
+
+ChecksumKind checksum_kind(const char* name)
+{
+    if(string_compare(name, checksum_name(CHECKSUM_CRC32C)))
+        return CHECKSUM_CRC32C;
+    else if(string_compare(name, checksum_name(CHECKSUM_XXH64)))
+        return CHECKSUM_XXH64;
+    return CHECKSUM_NONE;
+}
+
+void checksum_print(Checksum* sum, uint64 offset)
+{
+    if(sum->len == 0)
+        return;
+
+    io_printf("#%s %08llx %llx %0*llx\n", checksum_name(sum->kind), offset, sum->len,
+              (sum->kind == CHECKSUM_XXH64) ?16 :8, checksum_value(sum));
+    checksum_reset(sum, sum->kind);
+}
+
+// *********IMPLEMENTATION OF WORD API*********
+bool word_type_parse(const char* spec, WordType* type)
+{
+    type->cls = (WordClass)spec[0];
+    type->big_endian = false;
+
+    if(type->cls != WORD_UNSIGNED && type->cls != WORD_SIGNED &&
+            type->cls != WORD_HEX && type->cls != WORD_FLOAT)
+        return false;
+
+    ++spec;
+    int bits = 0;
+    while(isdigit(*spec) && bits < 100)
+        bits = bits * 10 + (*spec++ - '0');
+
+    if(string_compare(spec, "be"))
+        type->big_endian = true;
+    else if(!string_compare(spec, "le") && *spec != '\0')
+        return false;
+
+    type->size = bits / 8;
+    if(bits != 8 && bits != 16 && bits != 32 && bits != 64)
+        return false;
+
+    return type->cls != WORD_FLOAT || bits == 32 || bits == 64;
+}
+
+uint32 word_width(const WordType* type)
+{
+    // widths of maximal values, e.g. 4294967295, -2147483648
+    static const uint32 unsigned_widths[] = {3, 5, 0, 10, 0, 0, 0, 20};
+    static const uint32 signed_widths[] = {4, 6, 0, 11, 0, 0, 0, 20};
+
+    if(type->cls == WORD_HEX)
+        return type->size * 2;
+    else if(type->cls == WORD_FLOAT)
+        return (type->size == 4) ?14 :23;
+    else if(type->cls == WORD_SIGNED)
+        return signed_widths[type->size - 1];
+    return unsigned_widths[type->size - 1];
+}
+
+void words_decode(const uint8* data, uint32 count, const WordType* type, uint64* values)
+{
+    const bool swap = type->big_endian != (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__);
+
+    // separate loops for every size, so swaps are done on whole arrays
+    if(type->size == 1) {
+        for(uint32 i = 0; i < count; ++i)
+            values[i] = data[i];
+    }
+    else if(type->size == 2) {
+        uint16 words[count];
+        memcpy(words, data, count * 2);
+        if(swap) {
+            for(uint32 i = 0; i < count; ++i)
+                words[i] = __builtin_bswap16(words[i]);
+        }
+        for(uint32 i = 0; i < count; ++i)
+            values[i] = words[i];
+    }
+    else if(type->size == 4) {
+        uint32 words[count];
+        memcpy(words, data, count * 4);
+        if(swap) {
+            for(uint32 i = 0; i < count; ++i)
+                words[i] = __builtin_bswap32(words[i]);
+        }
+        for(uint32 i = 0; i < count; ++i)
+            values[i] = words[i];
+    }
+    else {
+        memcpy(values, data, count * 8);
+        if(swap) {
+            for(uint32 i = 0; i < count; ++i)
+                values[i] = __builtin_bswap64(values[i]);
+        }
+    }
+}
+
+char* word_format(const WordType* type, uint64 value, char* out)
+{
+    static const char hex_digits[] = "0123456789abcdef";
+    const uint32 width = word_width(type);
+    char* end = out + width;
+    char* position = end;
+
+    if(type->cls == WORD_FLOAT) {
+        char text[32];
+        double number;
+
+        if(type->size == 4) {
+            uint32 bits = value;
+            float single;
+            memcpy(&single, &bits, sizeof(single));
+            number = single;
+        }
+        else
+            memcpy(&number, &value, sizeof(number));
+
+        snprintf(text, sizeof(text), "%*.*g", (int)width, (type->size == 4) ?7 :16, number);
+        for(int i = 0; text[i] && out < end; ++i)
+            *out++ = text[i];
+        return out;
+    }
+
+    if(type->cls == WORD_HEX) {
+        while(position > out) {
+            *--position = hex_digits[value & 0xf];
+            value >>= 4;
+        }
+        return end;
+    }
+
+    // sign extend to 64 bits
+    bool negative = false;
+    if(type->cls == WORD_SIGNED) {
+        const uint32 shift = 64 - type->size * 8;
+        const long long extended = (long long)(value << shift) >> shift;
+
+        negative = extended < 0;
+        value = (negative) ?0 - (uint64)extended :(uint64)extended;
+    }
+
+    do {
+        *--position = '0' + value % 10;
+        value /= 10;
+    } while(value);
+
+    if(negative)
+        *--position = '-';
+    while(position > out)
+        *--position = ' ';
+
+    return end;
+}
+
+// *********IMPLEMENTATION OF SAMPLE API*********
+uint64 sample_random(uint64* state)
+{
+    uint64 z = (*state += 0x9e3779b97f4a7c15ULL);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static int sample_compare(const void* a, const void* b)
+{
+    const uint64 x = *(const uint64*)a;
+    const uint64 y = *(const uint64*)b;
+
+    return (x > y) - (x < y);
+}
+
+// insert block into open addressing set of chosen blocks, blocks are stored + 1
+static bool sample_insert(uint64* set, uint64 mask, uint64 value)
+{
+    uint64 i = (value * 0x9e3779b97f4a7c15ULL) & mask;
+
+    for(; set[i]; i = (i + 1) & mask) {
+        if(set[i] == value + 1)
+            return false;
+    }
+    set[i] = value + 1;
+
+    return true;
+}
+
+bool sample_offsets(uint64 start, uint64 size, uint64 block, uint64* count, uint64 seed, uint64* offsets)
+{
+    const uint64 blocks = (size > start) ?(size - start + block - 1) / block :0;
+    uint64 capacity = 1;
+
+    // every block is chosen
+    if(*count >= blocks) {
+        for(uint64 i = 0; i < blocks; ++i)
+            offsets[i] = start + i * block;
+        *count = blocks;
+        return true;
+    }
+
+    while(capacity < 2 * *count)
+        capacity *= 2;
+
+    uint64* set = calloc(capacity, sizeof(uint64));
+    if(set == NULL)
+        return false;
+
+    // Floyd's algorithm, every draw chooses new block, so nothing is drawn again
+    for(uint64 j = blocks - *count, i = 0; j < blocks; ++j, ++i) {
+        const uint64 drawn = sample_random(&seed) % (j + 1);
+        const uint64 chosen = (sample_insert(set, capacity - 1, drawn)) ?drawn :j;
+
+        if(chosen == j)
+            sample_insert(set, capacity - 1, j);
+        offsets[i] = start + chosen * block;
+    }
+
+    free(set);
+    qsort(offsets, *count, sizeof(uint64), sample_compare);
+
+    return true;
+}
+
+static off_t sample_size(int fd)
+{
+    struct stat st;
+
+    if(fd < 0 || fstat(fd, &st) != 0)
+        return -1;
+    if(S_ISREG(st.st_mode))
+        return st.st_size;
+    // block devices have no st_size, ioctl does not move offset shared with other readers
+    uint64 size;
+    return (S_ISBLK(st.st_mode) && ioctl(fd, BLKGETSIZE64, &size) == 0) ?(off_t)size :-1;
+}
+
+uint64 sample_read(uint64 offset, uint8* data, uint64 len, uint64* position)
+{
+    IoContext* io = io_context();
+    uint64 done = 0;
+
+    if(sample_size(io->in_fd) >= 0) {
+        while(done < len) {
+            const ssize_t n = pread(io->in_fd, data + done, len - done, offset + done);
+
+            if(n < 0 && errno == EINTR)
+                continue;
+            if(n <= 0)
+                break;
+            done += n;
+        }
+        return done;
+    }
+
+    // stream with known size (e.g. -d) can go back too
+    if(io->in_size >= 0 && fseeko(io->in, offset, SEEK_SET) == 0)
+        *position = offset;
+    else if(!io_skip(offset - *position)) {
+        *position = offset;
+        return 0;
+    }
+
+    done = fread(data, 1, len, io->in);
+    *position = offset + done;
+    return done;
+}
+
+void sample_print(uint64 address, const uint8* data, uint64 len)
+{
+    const int one_line_len = 16;
+    const int half_one_line_len = one_line_len / 2;
+    char buffer[] = "                ";
+
+    for(uint64 line = 0; line < len; line += one_line_len) {
+        const int line_char_count = (len - line < (uint64)one_line_len) ?(int)(len - line) :one_line_len;
+
+        io_printf("%08llx  ", address + line);
+        for(int i = 0; i < line_char_count; ++i) {
+            const uint8 c = data[line + i];
+
+            if(i == half_one_line_len)
+                io_printf(" ");
+            buffer[i] = (isprint(c)) ?c :'.';
+            io_printf("%02x ", c);
+        }
+
+        nprintf(' ', (16 - line_char_count) * 3);
+        nprintf(' ', line_char_count <= half_one_line_len);
+        io_printf(" |%s|\n", buffer);
+        string_fill(' ', buffer);
+    }
+}
+
+// *********IMPLEMENTATION OF SCAN API*********
+bool signature_add(SignatureSet* set, const char* name, const uint8* bytes, uint32 len)
+{
+    if(len == 0)
+        return false;
+
+    if(set->count == set->capacity) {
+        const uint32 capacity = (set->capacity) ?set->capacity * 2 :16;
+        Signature* items = realloc(set->items, capacity * sizeof(Signature));
+
+        if(items == NULL)
+            return false;
+        set->items = items;
+        set->capacity = capacity;
+    }
+
+    Signature* signature = &set->items[set->count];
+    if((signature->bytes = malloc(len)) == NULL)
+        return false;
+
+    snprintf(signature->name, SIGNATURE_NAME_SIZE, "%s", name);
+    memcpy(signature->bytes, bytes, len);
+    signature->len = len;
+    ++set->count;
+
+    return true;
+}
+
+bool signature_parse(SignatureSet* set, const char* line)
+{
+    char name[SIGNATURE_NAME_SIZE];
+    uint32 name_len = 0;
+    uint32 len = 0;
+    uint32 digits = 0;
+
+    while(isspace(*line))
+        ++line;
+    if(*line == '\0' || *line == '#')
+        return true;
+
+    while(*line != '\0' && !isspace(*line)) {
+        if(name_len < SIGNATURE_NAME_SIZE - 1)
+            name[name_len++] = *line;
+        ++line;
+    }
+    name[name_len] = '\0';
+
+    // every two digits are one byte, so line is long enough for bytes
+    uint8* bytes = malloc(string_len(line) / 2 + 1);
+    if(bytes == NULL)
+        return false;
+
+    for(; *line != '\0'; ++line) {
+        const uint8 value = hex_classify(*line);
+
+        if(value == HEX_SPACE)
+            continue;
+        if(value == HEX_INVALID)
+            break;
+
+        bytes[len] = (digits++ % 2) ?(bytes[len] << 4) | value :value;
+        len += (digits % 2) == 0;
+    }
+
+    const bool valid = *line == '\0' && digits % 2 == 0 && signature_add(set, name, bytes, len);
+    free(bytes);
+
+    return valid;
+}
+
+bool signature_builtin(SignatureSet* set)
+{
+    static const char* builtin[] = {
+        "elf 7f 45 4c 46",
+        "zip 50 4b 03 04",
+        "png 89 50 4e 47 0d 0a 1a 0a",
+        "gzip 1f 8b 08",
+        "bzip2 42 5a 68 39 31 41 59 26 53 59",
+        "xz fd 37 7a 58 5a 00",
+        "7z 37 7a bc af 27 1c",
+        "lzma 5d 00 00 80 00",
+        "zstd 28 b5 2f fd",
+        "jpeg ff d8 ff",
+        "gif 47 49 46 38",
+        "pdf 25 50 44 46 2d",
+        "cpio 30 37 30 37 30 31",
+        "squashfs 68 73 71 73",
+        "cramfs 45 3d cd 28",
+        "ubi 55 42 49 23",
+        "uimage 27 05 19 56",
+        "dtb d0 0d fe ed",
+        "android-boot 41 4e 44 52 4f 49 44 21",
+        "pe 4d 5a 90 00"
+    };
+
+    for(uint32 i = 0; i < sizeof(builtin) / sizeof(char*); ++i) {
+        if(!signature_parse(set, builtin[i]))
+            return false;
+    }
+
+    return true;
+}
+
+bool signature_load(SignatureSet* set, const char* path, uint32* line)
+{
+    FILE* f = fopen(path, "r");
+    char* buffer = NULL;
+    size_t capacity = 0;
+    bool valid = true;
+
+    *line = 0;
+    if(f == NULL)
+        return false;
+
+    while(valid && getline(&buffer, &capacity, f) != -1) {
+        ++*line;
+        valid = signature_parse(set, buffer);
+    }
+
+    if(valid && ferror(f)) {
+        *line = 0;
+        valid = false;
+    }
+
+    free(buffer);
+    fclose(f);
+    return valid;
+}
+
+void signature_free(SignatureSet* set)
+{
+    for(uint32 i = 0; i < set->count; ++i)
+        free(set->items[i].bytes);
+    free(set->items);
+
+    set->items = NULL;
+    set->count = 0;
+    set->capacity = 0;
+}
+
+bool automaton_build(Automaton* automaton, const SignatureSet* set)
+{
+    uint32 capacity = 1;
+
+    for(uint32 i = 0; i < set->count; ++i)
+        capacity += set->items[i].len;
+
+    automaton->next = calloc((size_t)capacity * 256, sizeof(uint32));
+    automaton->match = malloc(capacity * sizeof(int));
+    automaton->output = calloc(capacity, sizeof(uint32));
+    uint32* failure = calloc(capacity, sizeof(uint32));
+    uint32* queue = malloc(capacity * sizeof(uint32));
+    automaton->states = 1;
+
+    if(automaton->next == NULL || automaton->match == NULL || automaton->output == NULL ||
+            failure == NULL || queue == NULL) {
+        free(failure);
+        free(queue);
+        automaton_free(automaton);
+        return false;
+    }
+
+    automaton->match[0] = -1;
+
+    // trie, 0 is root and also "no transition" because nothing goes back to root
+    for(uint32 i = 0; i < set->count; ++i) {
+        uint32 state = 0;
+
+        for(uint32 j = 0; j < set->items[i].len; ++j) {
+            uint32* next = &automaton->next[state * 256 + set->items[i].bytes[j]];
+
+            if(*next == 0) {
+                automaton->match[automaton->states] = -1;
+                *next = automaton->states++;
+            }
+            state = *next;
+        }
+
+        // duplicate signature is reported once, under first name
+        if(automaton->match[state] < 0)
+            automaton->match[state] = i;
+    }
+
+    // breadth first, failure of state is always finished before its children
+    uint32 head = 0;
+    uint32 tail = 0;
+
+    for(int c = 0; c < 256; ++c) {
+        if(automaton->next[c])
+            queue[tail++] = automaton->next[c];
+    }
+
+    while(head < tail) {
+        const uint32 state = queue[head++];
+        const uint32 fail = failure[state];
+
+        automaton->output[state] = (automaton->match[fail] >= 0) ?fail :automaton->output[fail];
+
+        for(int c = 0; c < 256; ++c) {
+            uint32* next = &automaton->next[state * 256 + c];
+
+            if(*next) {
+                failure[*next] = automaton->next[fail * 256 + c];
+                queue[tail++] = *next;
+            }
+            else
+                *next = automaton->next[fail * 256 + c];
+        }
+    }
+
+    free(failure);
+    free(queue);
+    return true;
+}
+
+void automaton_free(Automaton* automaton)
+{
+    free(automaton->next);
+    free(automaton->match);
+    free(automaton->output);
+
+    automaton->next = NULL;
+    automaton->match = NULL;
+    automaton->output = NULL;
+    automaton->states = 0;
+}
+
+uint32 automaton_scan(const Automaton* automaton, const SignatureSet* set, uint32 state,
+                      const uint8* data, uint64 len, uint64 address,
+                      void (*hit)(void*, uint64, uint32), void* arg)
+{
+    const uint32* next = automaton->next;
+
+    for(uint64 i = 0; i < len; ++i) {
+        state = next[state * 256 + data[i]];
+
+        // most states match nothing, so this is the whole loop
+        if(automaton->match[state] < 0 && automaton->output[state] == 0)
+            continue;
+
+        for(uint32 s = state; s; s = automaton->output[s]) {
+            if(automaton->match[s] >= 0)
+                hit(arg, address + i + 1 - set->items[automaton->match[s]].len, automaton->match[s]);
+        }
+    }
+
+    return state;
+}
+
+// *********IMPLEMENTATION OF DUMP API*********
+unsigned int dump_line_len(uint64 address)
+{
+    unsigned int len = DUMP_LINE_LEN;
+
+    for(address >>= 32; address; address >>= 4)
+        ++len;
+
+    return len;
+}
+
+uint64 dump_offset(uint64 address, uint64 lines)
+{
+    uint64 offset = lines * DUMP_LINE_LEN;
+
+    // every line at or behind 16^digits has one more digit
+    for(unsigned int digits = 8; digits < 16; ++digits) {
+        const uint64 limit = 1ULL << (4 * digits);
+        const uint64 below = (address >= limit) ?0 :(limit - address + 15) / 16;
+
+        offset += (lines > below) ?lines - below :0;
+    }
+
+    return offset;
+}
+
+uint64 dump_size(uint64 address, uint64 len)
+{
+    // empty input still prints line without address
+    return (len) ?dump_offset(address, (len + 15) / 16) :DUMP_EMPTY_LINE_LEN;
+}
+
+void dump_line(char* out, uint64 address, const uint8* data, unsigned int n)
+{
+    static const char digits[] = "0123456789abcdef";
+    const unsigned int address_len = dump_line_len(address) - DUMP_LINE_LEN + 8;
+    char* text = out + address_len + DUMP_LINE_LEN - 8 - 18;
+
+    for(int i = address_len - 1; i >= 0; --i, address >>= 4)
+        out[i] = digits[address & 0xf];
+    out += address_len;
+    *out++ = ' ';
+    *out++ = ' ';
+
+    // half space is behind 8th byte, or behind padding of short line
+    for(unsigned int i = 0; i < 16; ++i) {
+        if(i == 8)
+            *out++ = ' ';
+
+        out[0] = (i < n) ?digits[data[i] >> 4] :' ';
+        out[1] = (i < n) ?digits[data[i] & 0xf] :' ';
+        out[2] = ' ';
+        out += 3;
+        text[i] = (i >= n) ?' ' :(isprint(data[i])) ?data[i] :'.';
+    }
+
+    out[0] = ' ';
+    out[1] = '|';
+    text[16] = '|';
+    text[17] = '\n';
+}
+
+void* dump_chunk(void* arg)
+{
+    DumpChunk* chunk = (DumpChunk*)arg;
+    uint64 offset = dump_offset(chunk->address, chunk->start / 16);
+
+    for(uint64 i = chunk->start; i < chunk->end; i += 16) {
+        const unsigned int n = (chunk->end - i < 16) ?chunk->end - i :16;
+
+        dump_line(chunk->out + offset, chunk->address + i, chunk->data + i, n);
+        offset += dump_line_len(chunk->address + i);
+    }
+
+    return NULL;
+}
+
+// *********IMPLEMENTATION OF PROCESS API*********
+bool process_parse_region(const char* line, ProcessRegion* region)
+{
+    char perms[5];
+    int name_offset = 0;
+
+    if(sscanf(line, "%llx-%llx %4s %*s %*s %*s %n", &region->start, &region->end, perms, &name_offset) < 3 ||
+            name_offset == 0)
+        return false;
+
+    const char* name = line + name_offset;
+    uint32 len = 0;
+
+    while(name[len] != '\0' && name[len] != '\n' && len < PROCESS_NAME_SIZE - 1) {
+        region->name[len] = name[len];
+        ++len;
+    }
+    region->name[len] = '\0';
+    region->readable = perms[0] == 'r';
+
+    return region->start <= region->end;
+}
+
+bool process_parse_range(const char* str, uint64* start, uint64* end)
+{
+    int len = 0;
+
+    if(sscanf(str, "%llx-%llx%n", start, end, &len) != 2 || str[len] != '\0' || !isxdigit(str[0]))
+        return false;
+
+    return *start <= *end;
+}
+
+bool process_regions(int pid, ProcessRegion** regions, uint32* count)
+{
+    char path[32];
+    char* line = NULL;
+    size_t capacity = 0;
+    uint32 regions_capacity = 0;
+
+    snprintf(path, sizeof(path), "/proc/%d/maps", pid);
+    FILE* f = fopen(path, "r");
+
+    *regions = NULL;
+    *count = 0;
+    if(f == NULL)
+        return false;
+
+    while(getline(&line, &capacity, f) != -1) {
+        if(*count == regions_capacity) {
+            regions_capacity = (regions_capacity) ?regions_capacity * 2 :64;
+            ProcessRegion* grown = realloc(*regions, regions_capacity * sizeof(ProcessRegion));
+
+            if(grown == NULL) {
+                io_error("ERROR: Out of memory\n");
+                free(*regions);
+                *regions = NULL;
+                *count = 0;
+                free(line);
+                fclose(f);
+                return false;
+            }
+            *regions = grown;
+        }
+
+        if(process_parse_region(line, &(*regions)[*count]))
+            ++*count;
+    }
+
+    free(line);
+    fclose(f);
+    return true;
+}
+
+ssize_t process_read(int pid, uint64 address, uint8* data, uint64 len)
+{
+    static long page_size = 0;
+    struct iovec local = {data, len};
+    struct iovec remote[1024];
+    unsigned long count = 0;
+
+    if(page_size == 0)
+        page_size = sysconf(_SC_PAGESIZE);
+
+    // partial reads are reported per iovec, so each page needs its own
+    uint64 position = address;
+    for(; position < address + len && count < 1024; ++count) {
+        const uint64 page_end = (position / page_size + 1) * page_size;
+        const uint64 end = (page_end < address + len) ?page_end :address + len;
+
+        remote[count].iov_base = (void*)(size_t)position;
+        remote[count].iov_len = end - position;
+        position = end;
+    }
+    local.iov_len = position - address;
+
+    const ssize_t n = process_vm_readv(pid, &local, 1, remote, count, 0);
+
+    // first page is unmapped
+    if(n < 0 && (errno == EFAULT || errno == EIO))
+        return 0;
+
+    return n;
+}
+
+// *********IMPLEMENTATION OF ELF API*********
+uint64 elf_value(const uint8* data, unsigned int size, bool big_endian)
+{
+    uint64 value = 0;
+
+    for(unsigned int i = 0; i < size; ++i)
+        value |= (uint64)data[(big_endian) ?size - 1 - i :i] << (8 * i);
+
+    return value;
+}
+
+bool elf_parse_header(const uint8* data, uint64 len, ElfHeader* header)
+{
+    if(len < 52 || data[0] != 0x7f || data[1] != 'E' || data[2] != 'L' || data[3] != 'F' ||
+            (data[4] != 1 && data[4] != 2) || (data[5] != 1 && data[5] != 2))
+        return false;
+
+    header->is64 = data[4] == 2;
+    header->big_endian = data[5] == 2;
+    if(header->is64 && len < 64)
+        return false;
+
+    const bool be = header->big_endian;
+    // 64 bit header has 8 bytes long entry, phoff and shoff
+    const unsigned int w = (header->is64) ?8 :4;
+
+    header->phoff = elf_value(data + 24 + w, w, be);
+    header->shoff = elf_value(data + 24 + 2 * w, w, be);
+    header->phentsize = elf_value(data + 24 + 3 * w + 6, 2, be);
+    header->phnum = elf_value(data + 24 + 3 * w + 8, 2, be);
+    header->shentsize = elf_value(data + 24 + 3 * w + 10, 2, be);
+    header->shnum = elf_value(data + 24 + 3 * w + 12, 2, be);
+    header->shstrndx = elf_value(data + 24 + 3 * w + 14, 2, be);
+
+    return (header->phnum == 0 || header->phentsize >= ((header->is64) ?56u :32u)) &&
+           (header->shoff == 0 || header->shentsize >= ((header->is64) ?64u :40u));
+}
+
+void elf_parse_section(const ElfHeader* header, const uint8* entry, ElfRegion* section)
+{
+    const bool be = header->big_endian;
+    const unsigned int w = (header->is64) ?8 :4;
+
+    section->name[0] = '\0';
+    section->name_offset = elf_value(entry, 4, be);
+    section->type = elf_value(entry + 4, 4, be);
+    section->address = elf_value(entry + 8 + w, w, be);
+    section->offset = elf_value(entry + 8 + 2 * w, w, be);
+    section->size = (section->type == SHT_NOBITS) ?0 :elf_value(entry + 8 + 3 * w, w, be);
+}
+
+void elf_parse_segment(const ElfHeader* header, const uint8* entry, uint32 index, ElfRegion* segment)
+{
+    const bool be = header->big_endian;
+
+    segment->type = elf_value(entry, 4, be);
+    segment->name_offset = 0;
+
+    // flags are behind type in 64 bit entry, but behind filesz in 32 bit one
+    if(header->is64) {
+        segment->offset = elf_value(entry + 8, 8, be);
+        segment->address = elf_value(entry + 16, 8, be);
+        segment->size = elf_value(entry + 32, 8, be);
+    }
+    else {
+        segment->offset = elf_value(entry + 4, 4, be);
+        segment->address = elf_value(entry + 8, 4, be);
+        segment->size = elf_value(entry + 16, 4, be);
+    }
+
+    snprintf(segment->name, ELF_NAME_SIZE, "%s[%u]", elf_segment_type(segment->type), index);
+}
+
+const char* elf_segment_type(uint32 type)
+{
+    switch(type) {
+        case PT_NULL: return "PT_NULL";
+        case PT_LOAD: return "PT_LOAD";
+        case PT_DYNAMIC: return "PT_DYNAMIC";
+        case PT_INTERP: return "PT_INTERP";
+        case PT_NOTE: return "PT_NOTE";
+        case PT_SHLIB: return "PT_SHLIB";
+        case PT_PHDR: return "PT_PHDR";
+        case PT_TLS: return "PT_TLS";
+        case PT_GNU_EH_FRAME: return "PT_GNU_EH_FRAME";
+        case PT_GNU_STACK: return "PT_GNU_STACK";
+        case PT_GNU_RELRO: return "PT_GNU_RELRO";
+        case PT_GNU_PROPERTY: return "PT_GNU_PROPERTY";
+    }
+
+    return "PT_UNKNOWN";
+}
+
+bool elf_name_match(const ElfRegion* region, bool segment, const char* name)
+{
+    if(string_compare(region->name, name))
+        return true;
+    if(!segment)
+        return false;
+
+    // PT_LOAD matches PT_LOAD[0], PT_LOAD[1], ...
+    const char* type = elf_segment_type(region->type);
+    return string_compare(type, name);
+}
+
+// *********IMPLEMENTATION OF CACHE API*********
+void cache_key(int flags, const int64* params, const char* argv[], uint64 input_hash, char* key)
+{
+    // these change only speed, not output
+    const int ignored = THREADS | INPUT_RATE | OUTPUT_RATE | BACKGROUND_IO | DIRECT_IO | CLIENT |
+                        CACHE | CACHE_LIMIT;
+    Checksum sum;
+    uint8 value[8];
+
+    flags &= ~ignored;
+    checksum_reset(&sum, CHECKSUM_XXH64);
+
+    for(int i = 0; i < FLAGS_COUNT; ++i) {
+        if((flags & (1 << i)) == 0)
+            continue;
+
+        const Actions action = (Actions)(1 << i);
+        value[0] = i;
+        checksum_update(&sum, value, 1);
+
+        if(flag_require_string(action)) {
+            const char* str = argv[params[i]];
+            checksum_update(&sum, (const uint8*)str, string_len(str) + 1);
+        }
+        else if(flag_accept_param(action)) {
+            for(int j = 0; j < 8; ++j)
+                value[j] = (uint64)params[i] >> (8 * j);
+            checksum_update(&sum, value, 8);
+        }
+    }
+
+    snprintf(key, CACHE_KEY_SIZE, "%016llx-%016llx", input_hash, checksum_value(&sum));
+}
+
+bool cache_lookup(Cache* cache, const char* dir, int flags, const int64* params, const char* argv[])
+{
+    // output depends on something else than input, or is not written to output
+    const int uncacheable = DUMP_FILE | DAEMON | PROCESS | PROCESS_RANGE | SCAN_FILE;
+    const uint64 chunk_size = 1 << 20;
+    IoContext* io = io_context();
+    struct stat st;
+    char key[CACHE_KEY_SIZE];
+    Checksum sum;
+
+    if((flags & uncacheable) || io->in_fd < 0 || fstat(io->in_fd, &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+
+    uint8* data = malloc(chunk_size);
+    off_t offset = lseek(io->in_fd, 0, SEEK_CUR);
+    if(data == NULL || offset < 0) {
+        free(data);
+        return false;
+    }
+
+    // hash pass does not move input, actions read it again on miss
+    checksum_reset(&sum, CHECKSUM_XXH64);
+    while(true) {
+        const ssize_t n = pread(io->in_fd, data, chunk_size, offset);
+
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n <= 0) {
+            free(data);
+            if(n < 0)
+                return false;
+            break;
+        }
+
+        checksum_update(&sum, data, n);
+        offset += n;
+    }
+
+    cache_key(flags, params, argv, checksum_value(&sum), key);
+    cache->dir = dir;
+    cache->fd = -1;
+    cache->failed = false;
+    cache->previous = io;
+
+    return snprintf(cache->path, PATH_MAX, "%s/%s", dir, key) < PATH_MAX;
+}
+
+bool cache_serve(Cache* cache, int* status, uint64 limit)
+{
+    IoContext* io = io_context();
+    struct stat st;
+    int fd = open(cache->path, O_RDONLY | O_CLOEXEC);
+
+    if(fd < 0)
+        return false;
+    if(fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    // entry stored with greater limit is computed again
+    if((uint64)st.st_size > limit) {
+        close(fd);
+        unlink(cache->path);
+        return false;
+    }
+
+    // modification time is time of last use
+    futimens(fd, NULL);
+    fflush(io->out);
+
+    uint64 sent = 0;
+    bool failed = false;
+
+    while(io->out_fd >= 0 && sent < (uint64)st.st_size) {
+        const ssize_t n = sendfile(io->out_fd, fd, NULL, st.st_size - sent);
+
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n <= 0) {
+            // sendfile can not write to this output, copy rest by hand
+            failed = n < 0 && errno != EINVAL && errno != ENOSYS;
+            break;
+        }
+        sent += n;
+    }
+
+    if(!failed && sent < (uint64)st.st_size) {
+        uint8 buffer[1 << 16];
+        ssize_t n;
+
+        lseek(fd, sent, SEEK_SET);
+        while((n = read(fd, buffer, sizeof(buffer))) > 0)
+            io_write(buffer, n);
+        failed = n < 0 || ferror(io->out);
+    }
+
+    close(fd);
+    if(failed)
+        io_error("ERROR: Unable to write output\n");
+
+    *status = (failed) ?EXIT_FAILURE :EXIT_SUCCESS;
+    return true;
+}
+
+static ssize_t cache_write(void* cookie, const char* buffer, size_t size)
+{
+    Cache* cache = (Cache*)cookie;
+
+    if(!cache->failed)
+        cache->failed = !output_write(cache->fd, buffer, size, -1);
+
+    return (fwrite(buffer, 1, size, cache->previous->out) == size) ?(ssize_t)size :-1;
+}
+
+static ssize_t cache_error(void* cookie, const char* buffer, size_t size)
+{
+    Cache* cache = (Cache*)cookie;
+
+    // output of failed run is not stored, even if it ends with success
+    cache->failed = true;
+    return (fwrite(buffer, 1, size, cache->previous->err) == size) ?(ssize_t)size :-1;
+}
+
+bool cache_begin(Cache* cache)
+{
+    cookie_io_functions_t out_functions = {NULL, cache_write, NULL, NULL};
+    cookie_io_functions_t err_functions = {NULL, cache_error, NULL, NULL};
+
+    mkdir(cache->dir, 0777);
+    if(snprintf(cache->temp, PATH_MAX, "%s/.tmp-XXXXXX", cache->dir) >= PATH_MAX ||
+            (cache->fd = mkstemp(cache->temp)) < 0)
+        return false;
+
+    // mkstemp creates entry only for its owner, umask can be read only by setting it
+    const mode_t mask = umask(0);
+    umask(mask);
+    fchmod(cache->fd, 0666 & ~mask);
+
+    cache->io = *cache->previous;
+    cache->io.out = fopencookie(cache, "w", out_functions);
+    cache->io.err = fopencookie(cache, "w", err_functions);
+    // actions writing with pwrite would bypass recording
+    cache->io.out_fd = -1;
+
+    if(cache->io.out == NULL || cache->io.err == NULL) {
+        if(cache->io.out)
+            fclose(cache->io.out);
+        if(cache->io.err)
+            fclose(cache->io.err);
+        close(cache->fd);
+        unlink(cache->temp);
+        return false;
+    }
+
+    fflush(cache->previous->out);
+    io_set_context(&cache->io);
+    return true;
+}
+
+void cache_end(Cache* cache, bool store, uint64 limit)
+{
+    fclose(cache->io.out);
+    fclose(cache->io.err);
+    fflush(cache->previous->out);
+    io_set_context(cache->previous);
+
+    // entry larger than whole cache would be evicted right away
+    struct stat st;
+    const bool fits = fstat(cache->fd, &st) == 0 && (uint64)st.st_size <= limit;
+    const bool closed = close(cache->fd) == 0;
+
+    store = store && !cache->failed && fits && closed;
+    if(!store || rename(cache->temp, cache->path) != 0)
+        unlink(cache->temp);
+
+    cache_evict(cache->dir, limit);
+}
+
+typedef struct
+{
+    char name[CACHE_KEY_SIZE];
+    struct timespec used;
+    uint64 size;
+} CacheEntry;
+
+static int cache_compare(const void* a, const void* b)
+{
+    const struct timespec* x = &((const CacheEntry*)a)->used;
+    const struct timespec* y = &((const CacheEntry*)b)->used;
+
+    if(x->tv_sec != y->tv_sec)
+        return (x->tv_sec > y->tv_sec) - (x->tv_sec < y->tv_sec);
+    return (x->tv_nsec > y->tv_nsec) - (x->tv_nsec < y->tv_nsec);
+}
+
+void cache_evict(const char* dir, uint64 limit)
+{
+    DIR* d = opendir(dir);
+    CacheEntry* entries = NULL;
+    uint64 count = 0;
+    uint64 capacity = 0;
+    uint64 total = 0;
+    struct dirent* entry;
+    struct stat st;
+
+    if(d == NULL)
+        return;
+
+    // only entries named by cache_key, nothing else in directory is touched
+    while((entry = readdir(d)) != NULL) {
+        if(string_len(entry->d_name) != CACHE_KEY_SIZE - 1 || entry->d_name[16] != '-' ||
+                fstatat(dirfd(d), entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0 || !S_ISREG(st.st_mode))
+            continue;
+
+        if(count == capacity) {
+            capacity = (capacity) ?capacity * 2 :64;
+            CacheEntry* grown = realloc(entries, capacity * sizeof(CacheEntry));
+
+            if(grown == NULL)
+                break;
+            entries = grown;
+        }
+
+        memcpy(entries[count].name, entry->d_name, CACHE_KEY_SIZE);
+        entries[count].used = st.st_mtim;
+        entries[count].size = st.st_size;
+        total += st.st_size;
+        ++count;
+    }
+
+    qsort(entries, count, sizeof(CacheEntry), cache_compare);
+    for(uint64 i = 0; i < count && total > limit; ++i) {
+        if(unlinkat(dirfd(d), entries[i].name, 0) == 0)
+            total -= entries[i].size;
+    }
+
+    free(entries);
+    closedir(d);
+}
+
+// *********IMPLEMENTATION OF ACTION API*********
+void action_unformated_hex(const DumpFormat* format)
+{
+    static const char digits[] = "0123456789abcdef";
+    uint8 data[4096];
+    char hex[2 * sizeof(data)];
+    Checksum sum;
+    uint64 offset = 0;
+    uint64 n;
+
+    checksum_reset(&sum, format->checksum_kind);
+
+    while((n = fread(data, 1, sizeof(data), io_context()->in)) > 0) {
+        for(uint64 done = 0; done < n;) {
+            // part ends with buffer or with checksum block
+            uint64 part = n - done;
+            if(format->checksum_block && part > format->checksum_block - sum.len)
+                part = format->checksum_block - sum.len;
+
+            for(uint64 i = 0; i < part; ++i) {
+                hex[2 * i] = digits[data[done + i] >> 4];
+                hex[2 * i + 1] = digits[data[done + i] & 0xf];
+            }
+            io_write(hex, 2 * part);
+
+            if(format->checksum_block) {
+                checksum_update(&sum, data + done, part);
+
+                if(sum.len == format->checksum_block) {
+                    io_printf("\n");
+                    checksum_print(&sum, offset);
+                    offset += format->checksum_block;
+                }
+            }
+            done += part;
+        }
+    }
+
+    // block is already finished by its checksum line
+    if(format->checksum_block == 0 || sum.len || offset == 0)
+        io_printf("\n");
+    checksum_print(&sum, offset);
+}
+
+int action_reverse()
+{
+    int c;
+    int char_counter = 0;
+    Hex8 h;
+
+    while((c = io_getc()) != EOF) {
+        if((!isxdigit(c)) && (!isspace(c)))
+            return EXIT_FAILURE;
+        if(!isxdigit(c))
+            continue;
+
+        if(char_counter % 2 == 0)    // another 2 char sequence
+            hex_null(&h);
+
+        h.hex[char_counter % 2] = c;
+
+        if(char_counter % 2)     // I have 2 hex symbols now convert to char
+            io_printf("%c", (char)strtol(h.hex, NULL, 16));
+        ++char_counter;
+    }
+
+    // len(h.hex) == 1 <=> hex has only on symbol, so convert and print it
+    if(string_len(h.hex) == 1)
+        io_printf("%c", (char)strtol(h.hex, NULL, 16));
+
+    return EXIT_SUCCESS;
+}
+
+int action_reverse_verify()
+{
+    int c;
+    int high = -1;
+    uint8* block = NULL;
+    uint64 block_len = 0;
+    uint64 block_capacity = 0;
+    uint64 offset = 0;
+    int status = EXIT_SUCCESS;
+
+    pthread_once(&hex_table_once, hex_table_init);
+
+    while(status == EXIT_SUCCESS && (c = io_getc()) != EOF) {
+        if(c == '#') {
+            char line[128];
+            char name[16];
+            unsigned int line_len = 0;
+            unsigned long long checked_offset, checked_len, value;
+            ChecksumKind kind = CHECKSUM_NONE;
+            Checksum sum;
+
+            while((c = io_getc()) != EOF && c != '\n') {
+                if(line_len < sizeof(line) - 1)
+                    line[line_len++] = c;
+            }
+            line[line_len] = '\0';
+
+            if(sscanf(line, "%15s %llx %llx %llx", name, &checked_offset, &checked_len, &value) == 4)
+                kind = checksum_kind(name);
+
+            checksum_reset(&sum, kind);
+            checksum_update(&sum, block, block_len);
+
+            // half of byte before checksum line means block was cut
+            if(kind == CHECKSUM_NONE || high >= 0 || checked_offset != offset ||
+                    checked_len != block_len || value != checksum_value(&sum)) {
+                io_error("ERROR: Checksum of block at %08llx does not match\n", offset);
+                status = EXIT_FAILURE;
+                break;
+            }
+
+            io_write(block, block_len);
+            offset += block_len;
+            block_len = 0;
+            continue;
+        }
+
+        const uint8 value = hex_table[c];
+
+        if(value == HEX_INVALID)
+            status = EXIT_FAILURE;
+        else if(value == HEX_SPACE)
+            continue;
+        else if(high < 0)
+            high = value;
+        else {
+            if(block_len == block_capacity) {
+                const uint64 capacity = (block_capacity) ?block_capacity * 2 :checksum_default_block;
+                uint8* grown = realloc(block, capacity);
+
+                if(grown == NULL) {
+                    io_error("ERROR: Out of memory\n");
+                    status = EXIT_FAILURE;
+                    break;
+                }
+                block = grown;
+                block_capacity = capacity;
+            }
+
+            block[block_len++] = (high << 4) | value;
+            high = -1;
+        }
+    }
+
+    if(status == EXIT_SUCCESS && (block_len || high >= 0)) {
+        io_error("ERROR: Missing checksum of block at %08llx\n", offset);
+        status = EXIT_FAILURE;
+    }
+
+    free(block);
+    return status;
 }
 
-Errors flags_validation(int argc, const char* argv[])
+int action_reverse_parallel(int threads)
 {
-    int previous_arg_was_flag = false;
-    int previous_flag_required_flag = false;
-    int flags = 0;
-    Actions action;
+    InputMap m;
+    if(!input_map(&m)) {
+        io_error("ERROR: Unable to read input\n");
+        return EXIT_FAILURE;
+    }
 
-    for(int i = 1; i < argc; ++i) {
-        if(flag_is_allowed(argv[i]) && !previous_flag_required_flag) {
-            action = distinguish_action(argv[i]);
-            // check for duplcations
-            if(flags & (int)action)
-                return FLAG_DUPLICATION;
+    pthread_once(&hex_table_once, hex_table_init);
+
+    // output is decoded in rounds, so its buffers are bounded, input of pipe is whole in memory
+    const uint64 chunk_size = 1 << 23;
+    const unsigned int workers = threads_count(threads);
+    IoContext* io = io_context();
+    const off_t base = (io->out_fd < 0) ?-1 :output_offset(io->out_fd);
+    ReverseChunk chunks[workers];
+    uint64 digits = 0;      // hex digits before current round
+    int last_digit = -1;
+    bool invalid = false;
+    bool failed = false;
+
+    for(unsigned int i = 0; i < workers; ++i) {
+        chunks[i].data = m.data;
+        chunks[i].fd = (base < 0) ?-1 :io->out_fd;
+        chunks[i].output = malloc(chunk_size / 2 + 1);
+
+        if(chunks[i].output == NULL) {
+            for(unsigned int j = 0; j < i; ++j)
+                free(chunks[j].output);
+            input_unmap(&m);
+            io_error("ERROR: Out of memory\n");
+            return EXIT_FAILURE;
+        }
+    }
 
-            flags |= (int)action;
-            previous_arg_was_flag = true;
-            previous_flag_required_flag = flag_require_param(action);
+    fflush(io->out);
+
+    for(uint64 position = 0; position < m.size && !invalid && !failed;) {
+        unsigned int count = 0;
+
+        for(; count < workers && position < m.size; ++count) {
+            chunks[count].start = position;
+            position = (m.size - position > chunk_size) ?position + chunk_size :m.size;
+            chunks[count].end = position;
         }
 
-        // if current arg is number and previous was allowed flag and flag accept param
-        else if(string_is_number(argv[i])) {
-            int flag_accept_parameter = flag_accept_param(distinguish_action(argv[i - 1]));
+        parallel_run(reverse_count_chunk, chunks, sizeof(ReverseChunk), count);
 
-            if(previous_arg_was_flag && !flag_accept_parameter)
-                return FLAG_NOT_EXPECT_PARAMETER_ERROR;
-            else if(!previous_arg_was_flag)
-                return UNEXPECTED_PARAMETER_ERROR;
-            previous_arg_was_flag = false;
-            previous_flag_required_flag = false;
+        // prefix pass, parity of digits before chunk says whether it starts with low nibble
+        for(unsigned int i = 0; i < count; ++i) {
+            chunks[i].carry = (digits % 2) ?last_digit :-1;
+            chunks[i].output_offset = (base < 0) ?-1 :base + (off_t)(digits / 2);
+            digits += chunks[i].digits;
+
+            if(chunks[i].last_digit >= 0)
+                last_digit = chunks[i].last_digit;
+
+            // action_reverse stops at invalid character, decode only what is before it
+            if(chunks[i].invalid < chunks[i].end) {
+                chunks[i].end = chunks[i].invalid;
+                count = i + 1;
+                invalid = true;
+            }
         }
 
-        else if(previous_flag_required_flag)
-            return MISSING_FLAG_PARAMETER;
+        parallel_run(reverse_decode_chunk, chunks, sizeof(ReverseChunk), count);
+
+        for(unsigned int i = 0; i < count; ++i) {
+            if(base < 0)
+                io_write(chunks[i].output, chunks[i].output_len);
+            failed |= chunks[i].failed || ferror(io->out);
+        }
+    }
+
+    // odd number of digits, last one is converted alone
+    if(!invalid && !failed && digits % 2) {
+        const uint8 c = last_digit;
+
+        if(base < 0)
+            io_write(&c, 1);
         else
-            return UNKNOWN_INPUT_ERROR;
+            failed = !output_write(io->out_fd, &c, 1, base + (off_t)(digits / 2));
     }
 
-    if(previous_flag_required_flag)
-        return MISSING_FLAG_PARAMETER;
+    if(base >= 0)
+        lseek(io->out_fd, base + (off_t)((digits + 1) / 2), SEEK_SET);
 
-    return NO_ERROR;
+    for(unsigned int i = 0; i < workers; ++i)
+        free(chunks[i].output);
+    input_unmap(&m);
+
+    if(failed)
+        io_error("ERROR: Unable to write output\n");
+
+    return (invalid || failed) ?EXIT_FAILURE :EXIT_SUCCESS;
 }
 
-bool flag_is_allowed(const char* str_flag)
+void action_split(unsigned int word_size)
 {
-    if(string_len(str_flag) < 2)
-        return false;
+    // set interval to word_size although it is not needed, because it works up to int / 2 - 1
+    if(word_size <= split_minimum_word_len || word_size >= split_maximum_word_len) {
+        print_help();
+        return;
+    }
 
-    const uint32 str_flag_len = string_len(str_flag);
-    char cleared_flag[3] = {'\0', '\0', '\0'};
+    register int c;
+    register unsigned int number_of_printable_chars = 0;
+    char buffer[word_size + 1];     // init and clear buffer
+    buffer[word_size] = '\0';
 
-    for(int i = 0; i < FLAGS_COUNT; ++i) {
-        // match symbol and has '-' and lenghts are equal
-        if(string_contain(STR_FLAGS[i][1], str_flag) && str_flag[0] == '-') {
-            cleared_flag[0] = STR_FLAGS[i][0];
-            cleared_flag[1] = STR_FLAGS[i][1];
-            // beacause if accept param, there is additionally one speciefer(ont symbol);
-            if(flag_accept_param(distinguish_action(cleared_flag)))
-                return (string_len(STR_FLAGS[i]) - 1) == str_flag_len;
-            else
-                return string_len(STR_FLAGS[i]) == str_flag_len;
+    while((c = io_getc()) != EOF && word_size > 0) {
+        if(number_of_printable_chars == word_size)    // indicate that the word exceeded word_size
+            io_printf("%s", buffer);
+
+        if(isprint(c) || isblank(c)) {
+            if(number_of_printable_chars < word_size)    // fill buffer
+                buffer[number_of_printable_chars] = c;
+            else                                      // print everything beyond filled buffer
+                io_printf("%c", c);
+            ++number_of_printable_chars;
+        }
+
+        else {      // prepare data for new word
+            if(number_of_printable_chars >= word_size)
+                io_printf("\n");
+            number_of_printable_chars = 0;
         }
     }
+}
 
-    return false;
+int action_split_parallel(unsigned int word_size, int threads, bool offsets, bool utf16)
+{
+    if(word_size <= split_minimum_word_len || word_size >= split_maximum_word_len) {
+        print_help();
+        return EXIT_SUCCESS;
+    }
+
+    InputMap m;
+    if(!input_map(&m)) {
+        io_error("ERROR: Unable to read input\n");
+        return EXIT_FAILURE;
+    }
+
+    // do not split small inputs, thread start would cost more than scan
+    const uint64 minimal_chunk_size = 1 << 16;
+    unsigned int chunks_count = threads_count(threads);
+    if(m.size / minimal_chunk_size + 1 < chunks_count)
+        chunks_count = m.size / minimal_chunk_size + 1;
+
+    SplitChunk chunks[chunks_count];
+
+    for(unsigned int i = 0; i < chunks_count; ++i) {
+        SplitChunk chunk = {m.data, m.size, m.size * i / chunks_count,
+                            m.size * (i + 1) / chunks_count, word_size, utf16, {{0}}};
+        chunks[i] = chunk;
+    }
+
+    parallel_run(split_scan_chunk, chunks, sizeof(SplitChunk), chunks_count);
+
+    SplitRunList runs[RUN_KINDS_COUNT] = {{0}};
+    uint64 next[RUN_KINDS_COUNT] = {0};
+    bool failed = false;
+
+    for(int kind = 0; kind < RUN_KINDS_COUNT; ++kind) {
+        split_stitch(chunks, chunks_count, (RunKind)kind, word_size, &runs[kind]);
+        failed = failed || runs[kind].failed;
+        for(unsigned int i = 0; i < chunks_count; ++i) {
+            failed = failed || chunks[i].runs[kind].failed;
+            free(chunks[i].runs[kind].items);
+        }
+    }
+
+    // merge kinds by offset, so output is in file order
+    while(!failed) {
+        int kind = -1;
+
+        for(int k = 0; k < RUN_KINDS_COUNT; ++k) {
+            if(next[k] < runs[k].count && (kind == -1 ||
+                    runs[k].items[next[k]].offset < runs[kind].items[next[kind]].offset))
+                kind = k;
+        }
+
+        if(kind == -1)
+            break;
+
+        const SplitRun* run = &runs[kind].items[next[kind]++];
+        // action_split does not finish word at the end of input, keep the same output
+        const bool at_end = kind == RUN_ASCII && run->offset + run->len == m.size;
+
+        if(at_end && run->len == word_size)
+            continue;
+
+        if(offsets)
+            io_printf("%08llx  ", run->offset);
+
+        if(kind == RUN_ASCII)
+            io_write(m.data + run->offset, run->len);
+        else {
+            for(uint64 i = 0; i < run->len; ++i)
+                io_printf("%c", m.data[run->offset + 2 * i]);
+        }
+
+        if(!at_end)
+            io_printf("\n");
+    }
+
+    for(int kind = 0; kind < RUN_KINDS_COUNT; ++kind)
+        free(runs[kind].items);
+    input_unmap(&m);
+
+    if(failed) {
+        io_error("ERROR: Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
 }
 
-// *********IMPLEMENTATION OF ACTION API*********
-void action_unformated_hex()
+void action_default(uint64 address, int64 count, const DumpFormat* format)
 {
-    int c;
-    while((c = getchar()) != EOF)
-        printf("%02x", c);
-    printf("\n");
+    const int one_line_len = 16;
+    const int half_one_line_len = one_line_len / 2;
+    register int line_char_count = 0;
+    register int c = '\0';
+    char buffer[] = "                ";
+    uint8 line[16];
+    Checksum sum;
+    uint64 block_address = address;
+
+    checksum_reset(&sum, format->checksum_kind);
+
+    if(count == 0)
+        return;
+
+    // skip characters
+    if(!io_skip(address))
+        return;
+
+    while (c != EOF) {
+        c = io_getc();
+
+        if(line_char_count == one_line_len || c == EOF || count == 0) {
+            nprintf(' ', (16 - line_char_count) * 3);
+            nprintf(' ', line_char_count <= half_one_line_len);
+            io_printf(" |%s|\n", buffer);
+            string_fill(' ', buffer);   // clear buffer
+
+            if(format->checksum_block) {
+                checksum_update(&sum, line, line_char_count);
+
+                // block is multiple of line, so it always ends with line
+                if(sum.len == format->checksum_block || c == EOF || count == 0) {
+                    const uint64 block_len = sum.len;
+                    checksum_print(&sum, block_address);
+                    block_address += block_len;
+                }
+            }
+
+            line_char_count = 0;
+
+            if(c == EOF || count == 0)  // beacause EOF == -1 -> c <= 0
+                break;
+        }
+
+        if(line_char_count == half_one_line_len)
+            io_printf(" ");
+
+        else if(line_char_count == 0)
+            io_printf("%08llx  ", address);   // print addr
+
+        buffer[line_char_count] = (isprint(c)) ?c :'.';
+        line[line_char_count] = c;
+        io_printf("%02x ", c);
+
+        ++line_char_count;
+        ++address;
+        --count;
+    }
 }
 
-void action_reverse()
+int action_typed(uint64 address, int64 count, const DumpFormat* format)
 {
-    int c;
-    int char_counter = 0;
-    Hex8 h;
+    const uint32 one_line_len = 16;
+    const uint32 lines_per_block = 256;
+    const WordType* type = &format->word;
+    const uint32 width = word_width(type);
+    const uint32 line_capacity = 24 + one_line_len * (width + 2) + one_line_len + 8;
+    uint8* data = malloc(one_line_len * lines_per_block);
+    char* line = malloc(line_capacity);
+    uint64 values[one_line_len];
+    uint64 remaining = (count < 0) ?(uint64)-1 :(uint64)count;
+    uint64 block_address = address;
+    Checksum sum;
+
+    if(data == NULL || line == NULL) {
+        free(data);
+        free(line);
+        io_error("ERROR: Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    checksum_reset(&sum, format->checksum_kind);
+
+    // skip characters
+    if(!io_skip(address))
+        remaining = 0;
+
+    while(remaining) {
+        const uint64 wanted = (remaining < one_line_len * lines_per_block) ?remaining
+                                                                           :one_line_len * lines_per_block;
+        const uint64 len = fread(data, 1, wanted, io_context()->in);
+
+        for(uint64 offset = 0; offset < len; offset += one_line_len) {
+            const uint8* bytes = data + offset;
+            const uint32 line_len = (len - offset < one_line_len) ?len - offset :one_line_len;
+            const uint32 words = (line_len + type->size - 1) / type->size;
+            char* out = line;
+
+            // last word of input is padded by zeros
+            uint8 padded[one_line_len];
+            if(words * type->size != line_len) {
+                memset(padded, 0, sizeof(padded));
+                memcpy(padded, bytes, line_len);
+                bytes = padded;
+            }
+
+            words_decode(bytes, words, type, values);
+            out += snprintf(out, 24, "%08llx  ", address);
+
+            for(uint32 i = 0; i < one_line_len / type->size; ++i) {
+                if(i * type->size == one_line_len / 2)
+                    *out++ = ' ';
+
+                if(i < words)
+                    out = word_format(type, values[i], out);
+                else {
+                    memset(out, ' ', width);
+                    out += width;
+                }
+                *out++ = ' ';
+            }
+
+            *out++ = ' ';
+            *out++ = '|';
+            for(uint32 i = 0; i < one_line_len; ++i)
+                *out++ = (i >= line_len) ?' ' :(isprint(data[offset + i])) ?data[offset + i] :'.';
+            *out++ = '|';
+            *out++ = '\n';
+
+            io_write(line, out - line);
+            address += line_len;
+
+            if(format->checksum_block) {
+                checksum_update(&sum, data + offset, line_len);
+                if(sum.len == format->checksum_block) {
+                    checksum_print(&sum, block_address);
+                    block_address += format->checksum_block;
+                }
+            }
+        }
+
+        remaining -= len;
+        if(len < wanted)
+            break;
+    }
+
+    if(format->checksum_block)
+        checksum_print(&sum, block_address);
+
+    free(data);
+    free(line);
+    return EXIT_SUCCESS;
+}
+
+int action_default_file(uint64 address, int64 count, const char* path, int threads)
+{
+    InputMap m;
+    if(!input_map(&m)) {
+        io_error("ERROR: Unable to read input\n");
+        return EXIT_FAILURE;
+    }
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if(fd < 0) {
+        input_unmap(&m);
+        io_error("ERROR: Unable to open %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    // action_default prints nothing if skip is behind end or count is 0
+    const bool empty = address > m.size || count == 0;
+    const uint64 available = (empty) ?0 :m.size - address;
+    const uint64 len = (count < 0 || (uint64)count > available) ?available :(uint64)count;
+    const uint64 size = (empty) ?0 :dump_size(address, len);
+    char* out = NULL;
+    bool failed = false;
+
+    if(size) {
+        // allocate whole file up front, so it is not fragmented and disk can not run out later
+        const int error = posix_fallocate(fd, 0, size);
+        failed = (error == EOPNOTSUPP || error == EINVAL) ?ftruncate(fd, size) != 0 :error != 0;
+
+        if(!failed) {
+            out = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            failed = out == MAP_FAILED;
+        }
+    }
+
+    if(!failed && len == 0 && size)
+        memcpy(out, "                                                 "
+                    " |                |\n", DUMP_EMPTY_LINE_LEN);
+    else if(!failed && size) {
+        const unsigned int workers = threads_count(threads);
+        const uint64 lines = (len + 15) / 16;
+        const uint64 lines_per_worker = (lines + workers - 1) / workers;
+        DumpChunk chunks[workers];
+        unsigned int used = 0;
+
+        for(uint64 line = 0; line < lines; line += lines_per_worker, ++used) {
+            chunks[used].data = m.data + address;
+            chunks[used].start = line * 16;
+            chunks[used].end = (lines - line > lines_per_worker) ?(line + lines_per_worker) * 16 :len;
+            chunks[used].address = address;
+            chunks[used].out = out;
+        }
+
+        parallel_run(dump_chunk, chunks, sizeof(DumpChunk), used);
+    }
+
+    if(out != NULL && out != MAP_FAILED)
+        failed |= munmap(out, size) != 0;
+    failed |= close(fd) != 0;
+    input_unmap(&m);
+
+    if(failed) {
+        io_error("ERROR: Unable to write %s\n", path);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int action_process(int pid, const char* selection, int64 count)
+{
+    const uint64 chunk_size = 1 << 20;
+    const long page_size = sysconf(_SC_PAGESIZE);
+    ProcessRegion* regions;
+    uint32 regions_count;
+    uint64 range_start = 0;
+    uint64 range_end = (uint64)-1;
+    uint64 remaining = (count < 0) ?(uint64)-1 :(uint64)count;
+    bool by_range = selection == NULL || process_parse_range(selection, &range_start, &range_end);
+
+    if(!process_regions(pid, &regions, &regions_count)) {
+        io_error("ERROR: Unable to read mappings of process %d\n", pid);
+        return EXIT_FAILURE;
+    }
+
+    uint8* data = malloc(chunk_size);
+    if(data == NULL) {
+        free(regions);
+        io_error("ERROR: Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    int status = EXIT_SUCCESS;
+    bool selected = false;
+    bool printed = false;
+
+    // mapping is looked up even for -n 0, so wrong selection is still reported
+    for(uint32 i = 0; i < regions_count && (remaining || !selected) && status == EXIT_SUCCESS; ++i) {
+        const ProcessRegion* region = &regions[i];
+        uint64 start = region->start;
+        uint64 end = region->end;
+
+        if(!region->readable)
+            continue;
+
+        if(by_range) {
+            start = (start > range_start) ?start :range_start;
+            end = (end < range_end) ?end :range_end;
+            if(start >= end)
+                continue;
+        }
+        else if(strstr(region->name, selection) == NULL)
+            continue;
+
+        selected = true;
+
+        while(start < end && remaining) {
+            uint64 len = (end - start < chunk_size) ?end - start :chunk_size;
+            len = (len < remaining) ?len :remaining;
+
+            const ssize_t n = process_read(pid, start, data, len);
+            if(n < 0) {
+                io_error("ERROR: Unable to read memory of process %d\n", pid);
+                status = EXIT_FAILURE;
+                break;
+            }
+
+            sample_print(start, data, n);
+            remaining -= n;
+            printed = printed || n > 0;
+
+            // skip unreadable page, e.g. guard page or [vvar]
+            start = ((uint64)n < len) ?(start + n) / page_size * page_size + page_size :start + n;
+        }
+    }
+
+    if(!selected && status == EXIT_SUCCESS) {
+        io_error("ERROR: Process %d has no readable mapping %s\n", pid, (selection) ?selection :"");
+        status = EXIT_FAILURE;
+    }
+    else if(!printed && count != 0 && status == EXIT_SUCCESS) {
+        io_error("ERROR: Mapping %s of process %d can not be read\n", (selection) ?selection :"", pid);
+        status = EXIT_FAILURE;
+    }
+
+    free(data);
+    free(regions);
+    return status;
+}
+
+static bool elf_read(uint64 offset, void* data, uint64 len, uint64* position)
+{
+    return sample_read(offset, (uint8*)data, len, position) == len;
+}
+
+static const char* elf_next_name(const char* next, char* name)
+{
+    uint32 len = 0;
+
+    for(; *next && *next != ','; ++next) {
+        if(len < ELF_NAME_SIZE - 1)
+            name[len++] = *next;
+    }
+    name[len] = '\0';
+
+    return next + (*next == ',');
+}
+
+int action_elf(const char* names)
+{
+    IoContext* io = io_context();
+    const off_t size = (io->in_size >= 0) ?io->in_size :sample_size(io->in_fd);
+    const uint64 chunk_size = 1 << 20;
+    uint8 ident[64] = {0};
+    uint64 position = 0;
+    ElfHeader header;
+
+    if(size < 0) {
+        io_error("ERROR: ELF input must be seekable file\n");
+        return EXIT_FAILURE;
+    }
+
+    if(!elf_read(0, ident, (size < 64) ?(uint64)size :64, &position) ||
+            !elf_parse_header(ident, (size < 64) ?(uint64)size :64, &header)) {
+        io_error("ERROR: Input is not ELF file\n");
+        return EXIT_FAILURE;
+    }
+
+    // only headers and requested regions are read
+    uint8* entries = NULL;
+    char* strings = NULL;
+    ElfRegion* regions = NULL;
+    uint32 sections = header.shnum;
+    uint32 shstrndx = header.shstrndx;
+    uint64 strings_size = 0;
+    bool valid = true;
+
+    // more sections than fits into header are stored in first section
+    if(header.shoff && (sections == 0 || shstrndx == SHN_XINDEX)) {
+        uint8 first[64];
+
+        valid = elf_read(header.shoff, first, (header.shentsize < 64) ?header.shentsize :64, &position);
+        if(valid) {
+            const unsigned int w = (header.is64) ?8 :4;
+            sections = (sections) ?sections :(uint32)elf_value(first + 8 + 3 * w, w, header.big_endian);
+            shstrndx = (shstrndx != SHN_XINDEX) ?shstrndx
+                                                :(uint32)elf_value(first + 8 + 4 * w, 4, header.big_endian);
+        }
+    }
+    if(!header.shoff)
+        sections = 0;
+
+    const uint32 total = sections + header.phnum;
+    const uint64 table_size = (uint64)sections * header.shentsize;
+    const uint64 program_size = (uint64)header.phnum * header.phentsize;
+
+    // damaged header must not make us allocate more than file has
+    if(!valid || table_size > (uint64)size || (sections && header.shoff > size - table_size) ||
+            program_size > (uint64)size || (header.phnum && header.phoff > size - program_size)) {
+        io_error("ERROR: ELF headers are truncated\n");
+        return EXIT_FAILURE;
+    }
+
+    regions = malloc((total) ?total * sizeof(ElfRegion) :1);
+    entries = malloc(((table_size > program_size) ?table_size :program_size) + 1);
+    if(regions == NULL || entries == NULL) {
+        free(regions);
+        free(entries);
+        io_error("ERROR: Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    // sections
+    valid = valid && (!sections || elf_read(header.shoff, entries, table_size, &position));
+    for(uint32 i = 0; valid && i < sections; ++i)
+        elf_parse_section(&header, entries + (uint64)i * header.shentsize, &regions[i]);
+
+    if(valid && sections && shstrndx < sections && regions[shstrndx].size <= (uint64)size) {
+        strings_size = regions[shstrndx].size;
+        strings = malloc(strings_size + 1);
+        if(strings == NULL) {
+            free(regions);
+            free(entries);
+            io_error("ERROR: Out of memory\n");
+            return EXIT_FAILURE;
+        }
+        valid = elf_read(regions[shstrndx].offset, strings, strings_size, &position);
+        strings[strings_size] = '\0';
+    }
+
+    for(uint32 i = 0; valid && strings && i < sections; ++i) {
+        if(regions[i].name_offset < strings_size)
+            snprintf(regions[i].name, ELF_NAME_SIZE, "%s", strings + regions[i].name_offset);
+    }
+
+    // segments
+    valid = valid && (!header.phnum || elf_read(header.phoff, entries, program_size, &position));
+    for(uint32 i = 0; valid && i < header.phnum; ++i) {
+        const uint8* entry = entries + (uint64)i * header.phentsize;
+        const uint32 type = elf_value(entry, 4, header.big_endian);
+        uint32 index = 0;
+
+        for(uint32 j = 0; j < i; ++j)
+            index += regions[sections + j].type == type;
+        elf_parse_segment(&header, entry, index, &regions[sections + i]);
+    }
+
+    free(entries);
+    free(strings);
+
+    if(!valid) {
+        free(regions);
+        io_error("ERROR: ELF headers are truncated\n");
+        return EXIT_FAILURE;
+    }
+
+    // check all names first, so nothing is printed for typo
+    char name[ELF_NAME_SIZE];
+    for(const char* next = names; valid && *next;) {
+        bool found = false;
+
+        next = elf_next_name(next, name);
+
+        for(uint32 i = 0; i < total && !found; ++i)
+            found = elf_name_match(&regions[i], i >= sections, name);
+
+        if(!found && name[0]) {
+            io_error("ERROR: ELF has no section or segment %s\n", name);
+            valid = false;
+        }
+    }
+
+    uint8* data = (valid) ?malloc(chunk_size) :NULL;
+    if(valid && data == NULL) {
+        free(regions);
+        io_error("ERROR: Out of memory\n");
+        return EXIT_FAILURE;
+    }
 
-    while((c = getchar()) != EOF) {
-        if((!isxdigit(c)) && (!isspace(c)))
-            exit(EXIT_FAILURE);
-        if(!isxdigit(c))
-            continue;
+    for(const char* next = names; valid && *next;) {
+        next = elf_next_name(next, name);
 
-        if(char_counter % 2 == 0)    // another 2 char sequence
-            hex_null(&h);
+        for(uint32 i = 0; i < total && name[0]; ++i) {
+            const ElfRegion* region = &regions[i];
+            // part behind end of file is not printed
+            const uint64 available = (region->offset < (uint64)size) ?size - region->offset :0;
+            const uint64 region_size = (region->size < available) ?region->size :available;
 
-        h.hex[char_counter % 2] = c;
+            if(!elf_name_match(region, i >= sections, name))
+                continue;
 
-        if(char_counter % 2)     // I have 2 hex symbols now convert to char
-            printf("%c", (char)strtol(h.hex, NULL, 16));
-        ++char_counter;
+            if(i < sections && region->type == SHT_NOBITS)
+                io_printf("section %s, offset %llx, no data in file\n", region->name, region->offset);
+            else
+                io_printf("%s %s, offset %llx, %llx bytes\n", (i >= sections) ?"segment" :"section",
+                          region->name, region->offset, region->size);
+
+            for(uint64 done = 0; done < region_size;) {
+                const uint64 part = (region_size - done < chunk_size) ?region_size - done :chunk_size;
+                const uint64 n = sample_read(region->offset + done, data, part, &position);
+
+                sample_print(region->address + done, data, n);
+                done += n;
+                if(n < part)
+                    break;
+            }
+        }
     }
 
-    // len(h.hex) == 1 <=> hex has only on symbol, so convert and print it
-    if(string_len(h.hex) == 1)
-        printf("%c", (char)strtol(h.hex, NULL, 16));
+    free(data);
+    free(regions);
+    return (valid) ?EXIT_SUCCESS :EXIT_FAILURE;
 }
 
-void action_split(unsigned int word_size)
+int action_sample(uint64 start, uint64 block, uint64 every, uint64 count, uint64 seed)
 {
-    // set interval to word_size although it is not needed, because it works up to int / 2 - 1
-    if(word_size <= split_minimum_word_len || word_size >= split_maximum_word_len) {
-        print_help();
-        return;
-    }
+    IoContext* io = io_context();
+    const off_t size = (io->in_size >= 0) ?io->in_size :sample_size(io->in_fd);
+    uint64* offsets = NULL;
+    uint8* data;
+    uint64 position = 0;
+
+    // samples following each other are one continuous dump
+    if(every && block > every)
+        block = every;
+
+    if(!every) {
+        if(size < 0) {
+            io_error("ERROR: Random samples need seekable input\n");
+            return EXIT_FAILURE;
+        }
 
-    register int c;
-    register unsigned int number_of_printable_chars = 0;
-    char buffer[word_size + 1];     // init and clear buffer
-    buffer[word_size] = '\0';
+        offsets = malloc(((count) ?count :1) * sizeof(uint64));
+        if(offsets == NULL) {
+            io_error("ERROR: Out of memory\n");
+            return EXIT_FAILURE;
+        }
+        if(!sample_offsets(start, size, block, &count, seed, offsets)) {
+            free(offsets);
+            io_error("ERROR: Out of memory\n");
+            return EXIT_FAILURE;
+        }
+    }
 
-    while((c = getchar()) != EOF && word_size > 0) {
-        if(number_of_printable_chars == word_size)    // indicate that the word exceeded word_size
-            printf("%s", buffer);
+    if((data = malloc(block)) == NULL) {
+        free(offsets);
+        io_error("ERROR: Out of memory\n");
+        return EXIT_FAILURE;
+    }
 
-        if(isprint(c) || isblank(c)) {
-            if(number_of_printable_chars < word_size)    // fill buffer
-                buffer[number_of_printable_chars] = c;
-            else                                      // print everything beyond filled buffer
-                printf("%c", c);
-            ++number_of_printable_chars;
-        }
+    for(uint64 i = 0; (every) ?(size < 0 || start + i * every < (uint64)size) :i < count; ++i) {
+        const uint64 offset = (every) ?start + i * every :offsets[i];
+        const uint64 len = sample_read(offset, data, block, &position);
 
-        else {      // prepare data for new word
-            if(number_of_printable_chars >= word_size)
-                printf("\n");
-            number_of_printable_chars = 0;
-        }
+        sample_print(offset, data, len);
+        if(len < block)
+            break;
     }
+
+    free(data);
+    free(offsets);
+    return EXIT_SUCCESS;
 }
 
-void action_default(uint32 address, int count)
+typedef struct
 {
-    const int one_line_len = 16;
-    const int half_one_line_len = one_line_len / 2;
-    register int line_char_count = 0;
-    register int c = '\0';
-    char buffer[] = "                ";
+    const SignatureSet* set;
+    uint32 context;
+    uint64* offsets;        // hits waiting for their context
+    uint32* signatures;
+    uint64 head;
+    uint64 count;
+    uint64 capacity;
+    bool failed;
+} ScanHits;
+
+static void scan_hit(void* arg, uint64 offset, uint32 signature)
+{
+    ScanHits* hits = (ScanHits*)arg;
 
-    if(count == 0)
+    if(hits->context == 0) {
+        io_printf("%08llx  %s\n", offset, hits->set->items[signature].name);
         return;
+    }
 
-    // skip characters
-    for(uint32 i = address; i--;) {
-        if(getchar() == EOF)
-            return;
+    if(hits->head + hits->count == hits->capacity) {
+        // reuse space of printed hits before growing
+        memmove(hits->offsets, hits->offsets + hits->head, hits->count * sizeof(uint64));
+        memmove(hits->signatures, hits->signatures + hits->head, hits->count * sizeof(uint32));
+        hits->head = 0;
+
+        if(hits->count * 2 >= hits->capacity) {
+            const uint64 capacity = (hits->capacity) ?hits->capacity * 2 :64;
+            uint64* offsets = realloc(hits->offsets, capacity * sizeof(uint64));
+            uint32* signatures = (offsets) ?realloc(hits->signatures, capacity * sizeof(uint32)) :NULL;
+
+            if(offsets)
+                hits->offsets = offsets;
+            if(signatures == NULL) {
+                hits->failed = true;
+                return;
+            }
+            hits->signatures = signatures;
+            hits->capacity = capacity;
+        }
     }
 
-    while (c != EOF) {
-        c = getchar();
+    hits->offsets[hits->head + hits->count] = offset;
+    hits->signatures[hits->head + hits->count] = signature;
+    ++hits->count;
+}
 
-        if(line_char_count == one_line_len || c == EOF || count == 0) {
-            nprintf(' ', (16 - line_char_count) * 3);
-            nprintf(' ', line_char_count <= half_one_line_len);
-            printf(" |%s|\n", buffer);
-            string_fill(' ', buffer);   // clear buffer
+int action_scan(const SignatureSet* set, uint32 context)
+{
+    const uint64 chunk_size = 1 << 16;
+    uint32 max_len = 0;
+    uint64 ring_size = 1;
+    uint64 address = 0;
+    uint32 state = 0;
+    Automaton automaton;
+    ScanHits hits = {set, context, NULL, NULL, 0, 0, 0, false};
+
+    for(uint32 i = 0; i < set->count; ++i)
+        max_len = (set->items[i].len > max_len) ?set->items[i].len :max_len;
+
+    // ring keeps chunk and everything pending hits can still need before it
+    while(ring_size < chunk_size + max_len + context)
+        ring_size *= 2;
+
+    uint8* chunk = malloc(chunk_size);
+    uint8* ring = (context) ?malloc(ring_size) :NULL;
+    uint8* window = (context) ?malloc(context) :NULL;
+
+    if(!automaton_build(&automaton, set) || chunk == NULL || (context && (ring == NULL || window == NULL))) {
+        if(automaton.next)
+            automaton_free(&automaton);
+        free(chunk);
+        free(ring);
+        free(window);
+        io_error("ERROR: Out of memory\n");
+        return EXIT_FAILURE;
+    }
 
-            line_char_count = 0;
+    bool end = false;
+    while(!end && !hits.failed) {
+        const uint64 n = fread(chunk, 1, chunk_size, io_context()->in);
+        end = n < chunk_size;
 
-            if(c == EOF || count == 0)  // beacause EOF == -1 -> c <= 0
-                break;
+        if(context) {
+            for(uint64 i = 0; i < n; ++i)
+                ring[(address + i) & (ring_size - 1)] = chunk[i];
         }
 
-        if(line_char_count == half_one_line_len)
-            printf(" ");
+        state = automaton_scan(&automaton, set, state, chunk, n, address, scan_hit, &hits);
+        address += n;
 
-        else if(line_char_count == 0)
-            printf("%08x  ", address);     // print addr
+        // print hits with whole context, at end of input also the rest
+        while(hits.count && (end || hits.offsets[hits.head] + context <= address)) {
+            const uint64 offset = hits.offsets[hits.head];
+            const uint64 len = (offset + context <= address) ?context :address - offset;
 
-        buffer[line_char_count] = (isprint(c)) ?c :'.';
-        printf("%02x ", c);
+            for(uint64 i = 0; i < len; ++i)
+                window[i] = ring[(offset + i) & (ring_size - 1)];
 
-        ++line_char_count;
-        ++address;
-        --count;
+            io_printf("%08llx  %s\n", offset, set->items[hits.signatures[hits.head]].name);
+            sample_print(offset, window, len);
+            ++hits.head;
+            --hits.count;
+        }
+    }
+
+    automaton_free(&automaton);
+    free(chunk);
+    free(ring);
+    free(window);
+    free(hits.offsets);
+    free(hits.signatures);
+
+    if(hits.failed) {
+        io_error("ERROR: Out of memory\n");
+        return EXIT_FAILURE;
     }
+
+    return EXIT_SUCCESS;
 }
 
 void print_help()
 {
-    fprintf(stderr, "HELP: Allowed combinations of flags and parameters are follow:\n"
-           "\t1. [-s M] [-n N]\n"
-           "\t2. -r\n"
-           "\t3. -S N, N > 0 and  N < 200\n"
-           "\t4. -x\n\n");
+    io_error("HELP: Allowed combinations of flags and parameters are follow:\n"
+           "\t1. [-s M] [-n N] [-c [B]] [-H] [-t TYPE]\n"
+           "\t   -t TYPE print words instead of bytes, TYPE is u, s, x or f followed by\n"
+           "\t   8, 16, 32 or 64 and optional le or be, e.g. u32le, f64be\n"
+           "\t   -c B print crc32c checksum line after every B bytes (default 4096),\n"
+           "\t   -H use xxh64 instead of crc32c\n"
+           "\t2. -r [-j T], -j T decode with T threads (0 = all cpus), input which is\n"
+           "\t   not regular file is then read into memory first\n"
+           "\t   -r -c, verify and strip checksum lines of -x -c output\n"
+           "\t3. -S N [-j T] [-o] [-u], N > 0 and  N < 200,\n"
+           "\t   -j T scan with T threads (0 = all cpus), -o print offsets, -u find UTF-16LE too\n"
+           "\t4. -x [-c [B]] [-H]\n"
+           "\t5. -D PATH [-j T], serve requests on Unix socket PATH with T workers\n"
+           "\t6. -C PATH ..., send request with other flags to daemon on PATH,\n"
+           "\t   run it here if daemon is not running\n"
+           "\t7. -e N [-s M] [-n B], print B bytes (default 64) every N bytes\n"
+           "\t   -k K [-z SEED] [-s M] [-n B], print K random blocks of B bytes\n"
+           "\t8. [-M] [-m FILE] [-w N], find built-in signatures (-M) and signatures\n"
+           "\t   from FILE with lines \"NAME HEX\", -w N print N bytes from every hit\n"
+           "\t9. -O FILE [-s M] [-n N] [-j T], write output of 1. to FILE with T threads\n"
+           "\t10. -p PID [-A RANGE] [-n N], print memory of process PID, RANGE is\n"
+           "\t   START-END in hex or part of mapping name from /proc/PID/maps\n"
+           "\t11. -E NAMES, print ELF sections and segments NAMES separated by ',',\n"
+           "\t   e.g. .rodata,.data,PT_LOAD or PT_LOAD[1] for one segment\n"
+           "\tThey also accept [-P DIR [-L MB]], output for same input file and\n"
+           "\tflags is served from cache in DIR, which is kept under MB (default 1024)\n"
+           "\tAll of them accept [-R B] [-W B] [-F] [-d], -R and -W limit input and output\n"
+           "\tto B bytes per second, -F drops read input from page cache and uses idle\n"
+           "\tio priority, -d reads input file with O_DIRECT, bypassing page cache\n\n");
 }
 
 void print_error(Errors err)
 {
     if(err == UNEXPECTED_PARAMETER_ERROR)
-        fprintf(stderr, "ERROR: Unexpected parameter in program arguments\n");
+        io_error("ERROR: Unexpected parameter in program arguments\n");
     else if(err == UNKNOWN_INPUT_ERROR)
-        fprintf(stderr, "ERROR: Unknown input in program arguments\n");
+        io_error("ERROR: Unknown input in program arguments\n");
     else if(err == FLAG_NOT_EXPECT_PARAMETER_ERROR)
-        fprintf(stderr, "ERROR: Flag do not expect parameter\n");
+        io_error("ERROR: Flag do not expect parameter\n");
     else if(err == MISSING_FLAG_PARAMETER)
-        fprintf(stderr, "ERROR: Missing flag parameter\n");
+        io_error("ERROR: Missing flag parameter\n");
     else if(err == FLAG_DUPLICATION)
-        fprintf(stderr, "ERROR: Flag duplication\n");
+        io_error("ERROR: Flag duplication\n");
 }
 
-int run_actions(int flags, int* params)
+int run_actions(int flags, int64* params, int argc, const char* argv[])
 {
-    if(((flags & (SKIP | NUMBER_OF_CHARS)) || flags == DEFAULT) &&
-            (flags & (~(SKIP | NUMBER_OF_CHARS))) == DEFAULT) {
+    int status = EXIT_SUCCESS;
+
+    // if daemon is not running, do the work here
+    if((flags & CLIENT) &&
+            daemon_client(argv[params[flag_index(CLIENT)]], argc, argv, params[flag_index(CLIENT)], &status))
+        return status;
+    flags &= ~CLIENT;
+
+    // output is taken from cache, or recorded into it
+    if(flags & CACHE) {
+        const int uncached = flags & (~(CACHE | CACHE_LIMIT));
+        const uint64 limit = (uint64)((flags & CACHE_LIMIT) ?params[flag_index(CACHE_LIMIT)]
+                                                            :cache_default_limit) << 20;
+        Cache cache;
+
+        if(!cache_lookup(&cache, argv[params[flag_index(CACHE)]], uncached, params, argv))
+            return run_actions(uncached, params, argc, argv);
+        if(cache_serve(&cache, &status, limit)) {
+            cache_evict(cache.dir, limit);
+            return status;
+        }
+
+        const bool recording = cache_begin(&cache);
+        status = run_actions(uncached, params, argc, argv);
+        if(recording)
+            cache_end(&cache, status == EXIT_SUCCESS, limit);
+        return status;
+    }
+
+    // run actions again with direct input, other inputs are read as usual
+    if(flags & DIRECT_IO) {
+        DirectReader reader;
+        const bool direct = direct_begin(&reader);
+
+        status = run_actions(flags & (~DIRECT_IO), params, argc, argv);
+        if(direct)
+            direct_end(&reader);
+        return status;
+    }
+
+    // run actions again, now with limited streams
+    if(flags & (INPUT_RATE | OUTPUT_RATE | BACKGROUND_IO)) {
+        Throttle throttle;
+
+        if(!throttle_begin(&throttle, (flags & INPUT_RATE) ?params[flag_index(INPUT_RATE)] :0,
+                           (flags & OUTPUT_RATE) ?params[flag_index(OUTPUT_RATE)] :0, flags & BACKGROUND_IO)) {
+            io_error("ERROR: Unable to limit input and output\n");
+            return EXIT_FAILURE;
+        }
+
+        status = run_actions(flags & (~(INPUT_RATE | OUTPUT_RATE | BACKGROUND_IO)), params, argc, argv);
+        throttle_end(&throttle);
+        return status;
+    }
+
+    // -H alone means xxh64 checksums with default block
+    DumpFormat format = {0, CHECKSUM_NONE, {WORD_HEX, 1, false}};
+    if(flags & (CHECKSUM | XXHASH)) {
+        format.checksum_block = (params[flag_index(CHECKSUM)] > 0) ?(uint32)params[flag_index(CHECKSUM)]
+                                                          :checksum_default_block;
+        format.checksum_kind = (flags & XXHASH) ?CHECKSUM_XXH64 :CHECKSUM_CRC32C;
+    }
+
+    if(((flags & (SKIP | NUMBER_OF_CHARS | CHECKSUM | XXHASH | TYPED)) || flags == DEFAULT) &&
+            (flags & (~(SKIP | NUMBER_OF_CHARS | CHECKSUM | XXHASH | TYPED))) == DEFAULT) {
         // replace if -n N is not present, rewrite param from 0 to -1 to ignore count
-        const int n_param = (params[(int)NUMBER_OF_CHARS] == 0 &&
+        const int64 n_param = (params[flag_index(NUMBER_OF_CHARS)] == 0 &&
                                   (flags & NUMBER_OF_CHARS) == 0)
-                                  ?-1 :params[(int)NUMBER_OF_CHARS];
-        action_default(params[(int)SKIP], n_param);
+                                  ?-1 :params[flag_index(NUMBER_OF_CHARS)];
+
+        if(format.checksum_block % 16) {
+            io_error("ERROR: Checksum block must be multiple of 16\n");
+            return EXIT_FAILURE;
+        }
+
+        if((flags & TYPED) == 0)
+            action_default(params[flag_index(SKIP)], n_param, &format);
+        else if(word_type_parse(argv[params[flag_index(TYPED)]], &format.word))
+            status = action_typed(params[flag_index(SKIP)], n_param, &format);
+        else {
+            io_error("ERROR: Unknown type %s\n", argv[params[flag_index(TYPED)]]);
+            print_help();
+        }
+    }
+    else if((flags & DUMP_FILE) && (flags & (~(DUMP_FILE | SKIP | NUMBER_OF_CHARS | THREADS))) == DEFAULT) {
+        const int64 n_param = (flags & NUMBER_OF_CHARS) ?params[flag_index(NUMBER_OF_CHARS)] :-1;
+
+        status = action_default_file(params[flag_index(SKIP)], n_param, argv[params[flag_index(DUMP_FILE)]],
+                                     params[flag_index(THREADS)]);
+    }
+    else if((flags & PROCESS) && (flags & (~(PROCESS | PROCESS_RANGE | NUMBER_OF_CHARS))) == DEFAULT) {
+        const int64 n_param = (flags & NUMBER_OF_CHARS) ?params[flag_index(NUMBER_OF_CHARS)] :-1;
+
+        status = action_process(params[flag_index(PROCESS)],
+                                (flags & PROCESS_RANGE) ?argv[params[flag_index(PROCESS_RANGE)]] :NULL, n_param);
+    }
+    else if(flags == ELF_TARGET)
+        status = action_elf(argv[params[flag_index(ELF_TARGET)]]);
+    else if(((flags & SAMPLE_EVERY) && (flags & (~(SAMPLE_EVERY | SKIP | NUMBER_OF_CHARS))) == DEFAULT) ||
+            ((flags & SAMPLE_RANDOM) && (flags & (~(SAMPLE_RANDOM | SAMPLE_SEED | SKIP | NUMBER_OF_CHARS))) == DEFAULT)) {
+        const uint64 block = (flags & NUMBER_OF_CHARS) ?(uint64)params[flag_index(NUMBER_OF_CHARS)]
+                                                      :sample_default_block;
+
+        if(block == 0 || ((flags & SAMPLE_EVERY) && params[flag_index(SAMPLE_EVERY)] <= 0)) {
+            io_error("ERROR: Sample size and distance must be positive\n");
+            return EXIT_FAILURE;
+        }
+
+        status = action_sample(params[flag_index(SKIP)], block, params[flag_index(SAMPLE_EVERY)],
+                               params[flag_index(SAMPLE_RANDOM)], params[flag_index(SAMPLE_SEED)]);
+    }
+    else if((flags & (SCAN | SCAN_FILE)) && (flags & (~(SCAN | SCAN_FILE | SCAN_CONTEXT))) == DEFAULT) {
+        SignatureSet set = {NULL, 0, 0};
+        uint32 line = 0;
+
+        // context is kept in memory and counted in uint32
+        if(params[flag_index(SCAN_CONTEXT)] > UINT_MAX) {
+            io_error("ERROR: Printed part of hit must be less than 4 GiB\n");
+            status = EXIT_FAILURE;
+        }
+        else if((flags & SCAN) && !signature_builtin(&set)) {
+            io_error("ERROR: Out of memory\n");
+            status = EXIT_FAILURE;
+        }
+        else if((flags & SCAN_FILE) && !signature_load(&set, argv[params[flag_index(SCAN_FILE)]], &line)) {
+            if(line)
+                io_error("ERROR: Invalid signature on line %u of %s\n", line, argv[params[flag_index(SCAN_FILE)]]);
+            else
+                io_error("ERROR: Unable to read signatures from %s\n", argv[params[flag_index(SCAN_FILE)]]);
+            status = EXIT_FAILURE;
+        }
+        else if(set.count == 0) {
+            io_error("ERROR: No signatures to scan for\n");
+            status = EXIT_FAILURE;
+        }
+        else
+            status = action_scan(&set, params[flag_index(SCAN_CONTEXT)]);
+
+        signature_free(&set);
     }
     else if(flags == REVERSE)
-        action_reverse();
+        status = action_reverse();
+    else if(flags == (REVERSE | THREADS))
+        status = action_reverse_parallel(params[flag_index(THREADS)]);
+    else if(flags == (REVERSE | CHECKSUM))
+        status = action_reverse_verify();
     else if (flags == SPLIT)
-        action_split(params[(int)SPLIT]);
-    else if(flags == UNFORMATED_HEX)
-        action_unformated_hex();
+        action_split(params[flag_index(SPLIT)]);
+    else if((flags & SPLIT) && (flags & (~(SPLIT | THREADS | OFFSETS | UTF16))) == DEFAULT)
+        status = action_split_parallel(params[flag_index(SPLIT)], params[flag_index(THREADS)],
+                                       flags & OFFSETS, flags & UTF16);
+    else if((flags & UNFORMATED_HEX) && (flags & (~(UNFORMATED_HEX | CHECKSUM | XXHASH))) == DEFAULT)
+        action_unformated_hex(&format);
+    else if((flags & DAEMON) && (flags & (~(DAEMON | THREADS))) == DEFAULT)
+        status = daemon_serve(argv[params[flag_index(DAEMON)]], params[flag_index(THREADS)]);
     // not allowed combinations of flags
     else {
-        fprintf(stderr, "ERROR: Your combination of flags is not allowed\n");
+        io_error("ERROR: Your combination of flags is not allowed\n");
         print_help();
         //return EXIT_SUCCESS;
     }
 
-    return EXIT_SUCCESS;
+    return status;
 }
 
 // *********IMPLEMENTATION OF TESTS*********
@@ -796,16 +5664,18 @@ void test_string_api()
 
     TST_CASE(
         "string_to_number",
-        TST_COMPARE(string_to_number("443432a"), -1);
-        TST_COMPARE(string_to_number("4434y32"), -1);
-        TST_COMPARE(string_to_number("a443432"), -1);
-        TST_COMPARE(string_to_number("4432"), 4432);
-        TST_COMPARE(string_to_number("09"), 9);
-        TST_COMPARE(string_to_number("009"), 9);
-        TST_COMPARE(string_to_number("090"), 90);
-        TST_COMPARE(string_to_number("123"), 123);
-        TST_COMPARE(string_to_number("2"), 2);
-        TST_COMPARE(string_to_number("0"), 0);
+        TST_COMPARE((int)string_to_number("443432a"), -1);
+        TST_COMPARE((int)string_to_number("4434y32"), -1);
+        TST_COMPARE((int)string_to_number("a443432"), -1);
+        TST_COMPARE((int)string_to_number("4432"), 4432);
+        TST_COMPARE((int)string_to_number("09"), 9);
+        TST_COMPARE((int)string_to_number("009"), 9);
+        TST_COMPARE((int)string_to_number("090"), 90);
+        TST_COMPARE(string_to_number("4294967296") == 4294967296LL, 1);
+        TST_COMPARE((int)string_to_number("9223372036854775808"), -1);
+        TST_COMPARE((int)string_to_number("123"), 123);
+        TST_COMPARE((int)string_to_number("2"), 2);
+        TST_COMPARE((int)string_to_number("0"), 0);
     );
 
     char str1[] = "ahoj";
@@ -834,6 +5704,18 @@ void test_hex_api()
         TST_COMPARE(h.hex[1], '\0');
         TST_COMPARE(h.hex[2], '\0');
     );
+
+    TST_CASE(
+        "hex_classify",
+        TST_COMPARE(hex_classify('0'), 0);
+        TST_COMPARE(hex_classify('9'), 9);
+        TST_COMPARE(hex_classify('a'), 10);
+        TST_COMPARE(hex_classify('F'), 15);
+        TST_COMPARE(hex_classify(' '), HEX_SPACE);
+        TST_COMPARE(hex_classify('\n'), HEX_SPACE);
+        TST_COMPARE(hex_classify('g'), HEX_INVALID);
+        TST_COMPARE(hex_classify('-'), HEX_INVALID);
+    );
 }
 
 void test_flag_api()
@@ -879,6 +5761,16 @@ void test_flag_api()
         TST_VERIFY(!flag_require_param(UNFORMATED_HEX));
         TST_VERIFY(flag_require_param(SPLIT));
         TST_VERIFY(!flag_require_param(REVERSE));
+        TST_VERIFY(flag_require_param(DAEMON));
+    );
+
+    TST_CASE(
+        "flag_require_string",
+        TST_VERIFY(!flag_require_string(UNDEFINED));
+        TST_VERIFY(!flag_require_string(SKIP));
+        TST_VERIFY(!flag_require_string(REVERSE));
+        TST_VERIFY(flag_require_string(DAEMON));
+        TST_VERIFY(flag_require_string(CLIENT));
     );
 
     const char* fc1[] = {"file", "1"};
@@ -892,6 +5784,9 @@ void test_flag_api()
     const char* fc9[] = {"file", "-S", "-x"};
     const char* fc10[] = {"file", "-r", "-r"};
     const char* fc11[] = {"file", "-n", "6", "-n", "2"};
+    const char* fc12[] = {"file", "-D"};
+    const char* fc13[] = {"file", "-C", "-x", "-x"};
+    const char* fc14[] = {"file", "-C", "1", "-S", "4"};
 
     TST_CASE(
         "flags_validation",
@@ -906,6 +5801,9 @@ void test_flag_api()
         TST_COMPARE(flags_validation(3, fc9), MISSING_FLAG_PARAMETER);
         TST_COMPARE(flags_validation(3, fc10), FLAG_DUPLICATION);
         TST_COMPARE(flags_validation(5, fc11), FLAG_DUPLICATION);
+        TST_COMPARE(flags_validation(2, fc12), MISSING_FLAG_PARAMETER);
+        TST_COMPARE(flags_validation(4, fc13), NO_ERROR);
+        TST_COMPARE(flags_validation(5, fc14), NO_ERROR);
     );
 
     TST_CASE(
@@ -922,7 +5820,7 @@ void test_flag_api()
         TST_COMPARE(flag_is_allowed("-n6"), false);
     );
 
-    int params[17];
+    int64 params[FLAGS_COUNT];
     const char* d_test_arg[] = {"file"};
     const char* S1_test_arg[] = {"file", "-S"};
     const char* S2_test_arg[] = {"file", "-S", "4"};
@@ -930,31 +5828,527 @@ void test_flag_api()
     const char* r2_test_arg[] = {"file", "-r"};
     const char* Ss_test_arg[] = {"file", "-S", "3", "-s"};
     const char* ns_test_arg[] = {"file", "-n", "3", "-s", "5"};
+    const char* D_test_arg[] = {"file", "-D", "/tmp/socket", "-j", "2"};
+    const char* C_test_arg[] = {"file", "-C", "-x", "-x"};
 
     TST_CASE(
         "parse_arguments",
         TST_COMPARE(parse_arguments(2, S1_test_arg, params), SPLIT);
-        TST_COMPARE(params[(int)SPLIT], -2);
+        TST_COMPARE((int)params[flag_index(SPLIT)], -2);
 
         TST_COMPARE(parse_arguments(3, S2_test_arg, params), SPLIT);
-        TST_COMPARE(params[(int)SPLIT], 4);
+        TST_COMPARE((int)params[flag_index(SPLIT)], 4);
 
         TST_COMPARE(parse_arguments(3, r1_test_arg, params), REVERSE);
-        TST_COMPARE(params[(int)REVERSE], -1);
+        TST_COMPARE((int)params[flag_index(REVERSE)], -1);
 
         TST_COMPARE(parse_arguments(2, r2_test_arg, params), REVERSE);
-        TST_COMPARE(params[(int)REVERSE], 0);
+        TST_COMPARE((int)params[flag_index(REVERSE)], 0);
 
         TST_COMPARE(parse_arguments(4, Ss_test_arg, params), SKIP | SPLIT);
-        TST_COMPARE(params[(int)SPLIT], 3);
-        TST_COMPARE(params[(int)SKIP], -2);
+        TST_COMPARE((int)params[flag_index(SPLIT)], 3);
+        TST_COMPARE((int)params[flag_index(SKIP)], -2);
 
         TST_COMPARE(parse_arguments(1, d_test_arg, params), DEFAULT);
 
         TST_COMPARE(parse_arguments(5, ns_test_arg, params), SKIP | NUMBER_OF_CHARS);
-        TST_COMPARE(params[(int)SKIP], 5);
-        TST_COMPARE(params[(int)NUMBER_OF_CHARS], 3);
+        TST_COMPARE((int)params[flag_index(SKIP)], 5);
+        TST_COMPARE((int)params[flag_index(NUMBER_OF_CHARS)], 3);
+
+        TST_COMPARE(parse_arguments(5, D_test_arg, params), DAEMON | THREADS);
+        TST_COMPARE((int)params[flag_index(DAEMON)], 2);
+        TST_COMPARE((int)params[flag_index(THREADS)], 2);
+
+        TST_COMPARE(parse_arguments(4, C_test_arg, params), CLIENT | UNFORMATED_HEX);
+        TST_COMPARE((int)params[flag_index(CLIENT)], 2);
+    );
+
+}
+
+void test_split_api()
+{
+    const uint8 data[] = "hello\1wor" "ld\1x" "\1a\0b\0c\0d\0";
+    const uint64 size = sizeof(data) - 1;
+    SplitChunk chunks[2] = {
+        {data, size, 0, 8, 3, true, {{0}}},
+        {data, size, 8, size, 3, true, {{0}}}
+    };
+    SplitRunList ascii = {0};
+    SplitRunList utf16 = {0};
+
+    split_scan_chunk(&chunks[0]);
+    split_scan_chunk(&chunks[1]);
+    split_stitch(chunks, 2, RUN_ASCII, 3, &ascii);
+    split_stitch(chunks, 2, RUN_UTF16_EVEN, 3, &utf16);
+
+    TST_CASE(
+        "split_is_printable",
+        TST_VERIFY(split_is_printable('a'));
+        TST_VERIFY(split_is_printable(' '));
+        TST_VERIFY(split_is_printable('\t'));
+        TST_VERIFY(!split_is_printable('\n'));
+        TST_VERIFY(!split_is_printable('\0'));
+        TST_VERIFY(!split_is_printable(200));
+    );
+
+    TST_CASE(
+        "split_stitch",
+        TST_COMPARE((int)ascii.count, 2);
+        TST_COMPARE((int)ascii.items[0].offset, 0);
+        TST_COMPARE((int)ascii.items[0].len, 5);
+        TST_COMPARE((int)ascii.items[1].offset, 6);
+        TST_COMPARE((int)ascii.items[1].len, 5);
+        TST_COMPARE((int)utf16.count, 1);
+        TST_COMPARE((int)utf16.items[0].offset, 14);
+        TST_COMPARE((int)utf16.items[0].len, 4);
+    );
+
+    for(int kind = 0; kind < RUN_KINDS_COUNT; ++kind) {
+        free(chunks[0].runs[kind].items);
+        free(chunks[1].runs[kind].items);
+    }
+    free(ascii.items);
+    free(utf16.items);
+}
+
+void test_checksum_api()
+{
+    const uint8 digits[] = "123456789";
+    const uint8 text[] = "Nobody inspects the spammish repetition";
+    Checksum sum;
+
+    TST_CASE(
+        "crc32c_update",
+        TST_VERIFY(crc32c_update(0, digits, 9) == 0xE3069283u);
+        TST_VERIFY(crc32c_update(crc32c_update(0, digits, 4), digits + 4, 5) == 0xE3069283u);
+        TST_VERIFY(crc32c_update(0, digits, 0) == 0);
+    );
+
+    checksum_reset(&sum, CHECKSUM_XXH64);
+    const bool xxh64_empty = checksum_value(&sum) == 0xEF46DB3751D8E999ULL;
+    checksum_update(&sum, (const uint8*)"abc", 3);
+    const bool xxh64_abc = checksum_value(&sum) == 0x44BC2CF5AD770999ULL;
+
+    // long input fed in uneven pieces must give same value as one piece
+    Checksum whole;
+    checksum_reset(&whole, CHECKSUM_XXH64);
+    checksum_update(&whole, text, sizeof(text) - 1);
+    checksum_reset(&sum, CHECKSUM_XXH64);
+    checksum_update(&sum, text, 5);
+    checksum_update(&sum, text + 5, 30);
+    checksum_update(&sum, text + 35, sizeof(text) - 36);
+
+    TST_CASE(
+        "checksum_value",
+        TST_VERIFY(xxh64_empty);
+        TST_VERIFY(xxh64_abc);
+        TST_VERIFY(checksum_value(&whole) == 0xFBCEA83C8A378BF1ULL);
+        TST_VERIFY(checksum_value(&sum) == checksum_value(&whole));
+        TST_COMPARE((int)sum.len, (int)sizeof(text) - 1);
+    );
+
+    TST_CASE(
+        "checksum_kind",
+        TST_COMPARE(checksum_kind("crc32c"), CHECKSUM_CRC32C);
+        TST_COMPARE(checksum_kind("xxh64"), CHECKSUM_XXH64);
+        TST_COMPARE(checksum_kind("md5"), CHECKSUM_NONE);
+    );
+}
+
+void test_throttle_api()
+{
+    TokenBucket bucket;
+    struct timespec now;
+
+    token_bucket_init(&bucket, 1000);
+    now = bucket.last;
+
+    // empty bucket, 500 B at 1000 B/s must wait half of second
+    const uint64 first = token_bucket_delay(&bucket, 500, &now);
+    now.tv_sec += 1;
+    // after one second debt is paid and 100 ms burst is saved
+    const uint64 second = token_bucket_delay(&bucket, 100, &now);
+
+    token_bucket_init(&bucket, 0);
+    const uint64 unlimited = token_bucket_delay(&bucket, 1 << 30, &now);
+
+    TST_CASE(
+        "token_bucket_delay",
+        TST_COMPARE((int)(first / 1000000), 500);
+        TST_COMPARE((int)second, 0);
+        TST_COMPARE((int)unlimited, 0);
+    );
+
+    // regular file stays seekable through throttled stream
+    FILE* file = tmpfile();
+    IoContext io = {file, stdout, stderr, (file) ?fileno(file) :-1, STDOUT_FILENO, -1};
+    Throttle throttle;
+    uint64 position = 0;
+    uint8 data[4] = {0};
+    bool throttled = false;
+    off_t size = -1;
+
+    if(file && fwrite("0123456789", 1, 10, file) == 10 && fflush(file) == 0) {
+        io_set_context(&io);
+        throttled = throttle_begin(&throttle, 1 << 30, 0, true);
+        if(throttled) {
+            size = io_context()->in_size;
+            sample_read(6, data, 4, &position);
+            sample_read(2, data, 2, &position);
+            throttle_end(&throttle);
+        }
+        io_set_context(NULL);
+    }
+    if(file)
+        fclose(file);
+
+    TST_CASE(
+        "throttled_seek",
+        TST_VERIFY(throttled);
+        TST_COMPARE((int)size, 10);
+        TST_VERIFY(data[0] == '2' && data[1] == '3' && data[2] == '8' && data[3] == '9');
+    );
+}
+
+void test_word_api()
+{
+    WordType type;
+    const uint8 data[] = {0x01, 0x02, 0xff, 0xff, 0x00, 0x00, 0x80, 0x3f};
+    uint64 values[4];
+    char out[32];
+
+    TST_CASE(
+        "word_type_parse",
+        TST_VERIFY(word_type_parse("u32le", &type) && type.size == 4 && !type.big_endian);
+        TST_VERIFY(word_type_parse("s16be", &type) && type.size == 2 && type.big_endian);
+        TST_VERIFY(word_type_parse("x64", &type) && type.cls == WORD_HEX);
+        TST_VERIFY(word_type_parse("f32", &type));
+        TST_VERIFY(!word_type_parse("f16", &type));
+        TST_VERIFY(!word_type_parse("u24", &type));
+        TST_VERIFY(!word_type_parse("u32xe", &type));
+        TST_VERIFY(!word_type_parse("q32", &type));
+    );
+
+    word_type_parse("u16be", &type);
+    words_decode(data, 4, &type, values);
+    out[word_format(&type, values[0], out) - out] = '\0';
+
+    TST_CASE(
+        "words_decode",
+        TST_COMPARE((int)values[0], 0x0102);
+        TST_COMPARE((int)values[1], 0xffff);
+        TST_VERIFY(string_compare(out, "  258"));
+    );
+
+    word_type_parse("s16le", &type);
+    words_decode(data, 4, &type, values);
+    out[word_format(&type, values[1], out) - out] = '\0';
+    const bool signed_ok = string_compare(out, "    -1");
+
+    word_type_parse("f32le", &type);
+    words_decode(data + 4, 1, &type, values);
+    out[word_format(&type, values[0], out) - out] = '\0';
+    const bool float_ok = string_compare(out, "             1");
+
+    word_type_parse("x32le", &type);
+    words_decode(data, 2, &type, values);
+    out[word_format(&type, values[0], out) - out] = '\0';
+
+    TST_CASE(
+        "word_format",
+        TST_VERIFY(signed_ok);
+        TST_VERIFY(float_ok);
+        TST_VERIFY(string_compare(out, "ffff0201"));
+    );
+}
+
+void test_sample_api()
+{
+    uint64 first = 7;
+    uint64 second = 7;
+    uint64 offsets[256];
+    uint64 count = 8;
+    uint64 all = 256;
+    uint64 almost_all = 255;
+    bool valid = true;
+
+    TST_CASE(
+        "sample_random",
+        TST_VERIFY(sample_random(&first) == sample_random(&second));
+        TST_VERIFY(sample_random(&first) != sample_random(&first));
+    );
+
+    TST_CASE(
+        "sample_offsets",
+        TST_VERIFY(sample_offsets(10, 50, 16, &count, 1, offsets));
+        TST_COMPARE((int)count, 3);
+        TST_COMPARE((int)offsets[0], 10);
+        TST_COMPARE((int)offsets[2], 42);
+        count = 8;
+        TST_VERIFY(sample_offsets(60, 50, 16, &count, 1, offsets));
+        TST_COMPARE((int)count, 0);
+    );
+
+    count = 8;
+    sample_offsets(0, 4096, 16, &count, 3, offsets);
+    for(uint64 i = 0; i < count; ++i)
+        valid = valid && offsets[i] % 16 == 0 && offsets[i] < 4096 && (i == 0 || offsets[i - 1] < offsets[i]);
+
+    TST_CASE(
+        "sample_offsets random",
+        TST_COMPARE((int)count, 8);
+        TST_VERIFY(valid);
+    );
+
+    // all blocks but one, every block is chosen once
+    sample_offsets(0, 4096, 16, &almost_all, 3, offsets);
+    for(uint64 i = 0; i < almost_all; ++i)
+        valid = valid && offsets[i] % 16 == 0 && offsets[i] < 4096 && (i == 0 || offsets[i - 1] < offsets[i]);
+
+    TST_CASE(
+        "sample_offsets all",
+        TST_COMPARE((int)almost_all, 255);
+        TST_VERIFY(valid);
+        TST_VERIFY(sample_offsets(0, 4096, 16, &all, 3, offsets));
+        TST_COMPARE((int)all, 256);
+        TST_COMPARE((int)offsets[255], 4080);
+    );
+}
+
+static void test_scan_hit(void* arg, uint64 offset, uint32 signature)
+{
+    uint64* hits = (uint64*)arg;
+
+    // offset and signature of each hit packed into one number
+    hits[1 + hits[0]++] = offset * 16 + signature;
+}
+
+void test_scan_api()
+{
+    SignatureSet set = {NULL, 0, 0};
+    Automaton automaton;
+    uint64 hits[16] = {0};
+    const uint8 text[] = "ushers";
+
+    TST_CASE(
+        "signature_parse",
+        TST_VERIFY(signature_parse(&set, "he 68 65"));
+        TST_VERIFY(signature_parse(&set, "  she 73 6865\n"));
+        TST_VERIFY(signature_parse(&set, "# comment"));
+        TST_VERIFY(signature_parse(&set, ""));
+        TST_VERIFY(signature_parse(&set, "his 686973"));
+        TST_VERIFY(signature_parse(&set, "hers 68 65 72 73"));
+        TST_VERIFY(!signature_parse(&set, "odd 686"));
+        TST_VERIFY(!signature_parse(&set, "bad 68 zz"));
+        TST_VERIFY(!signature_parse(&set, "empty"));
+        TST_COMPARE((int)set.count, 4);
+        TST_COMPARE((int)set.items[1].len, 3);
+        TST_VERIFY(string_compare(set.items[1].name, "she"));
+    );
+
+    const bool built = automaton_build(&automaton, &set);
+    // split input, match must continue over boundary
+    uint32 state = automaton_scan(&automaton, &set, 0, text, 3, 100, test_scan_hit, hits);
+    automaton_scan(&automaton, &set, state, text + 3, 3, 103, test_scan_hit, hits);
+
+    TST_CASE(
+        "automaton_scan",
+        TST_VERIFY(built);
+        TST_COMPARE((int)hits[0], 3);
+        TST_COMPARE((int)hits[1], 101 * 16 + 1);
+        TST_COMPARE((int)hits[2], 102 * 16 + 0);
+        TST_COMPARE((int)hits[3], 102 * 16 + 3);
+    );
+
+    automaton_free(&automaton);
+    signature_free(&set);
+}
+
+void test_dump_api()
+{
+    const uint8 data[] = "Hello, world!\n\1\2xyz";
+    char full[DUMP_LINE_LEN + 1] = {0};
+    char half[DUMP_LINE_LEN + 1] = {0};
+    char short_line[DUMP_LINE_LEN + 1] = {0};
+
+    dump_line(full, 0x10, data, 16);
+    dump_line(half, 0xabcdef12, data, 9);
+    dump_line(short_line, 0, data + 16, 3);
+
+    TST_CASE(
+        "dump_size",
+        TST_COMPARE((int)dump_size(0, 0), DUMP_EMPTY_LINE_LEN);
+        TST_COMPARE((int)dump_size(0, 1), DUMP_LINE_LEN);
+        TST_COMPARE((int)dump_size(0, 16), DUMP_LINE_LEN);
+        TST_COMPARE((int)dump_size(0, 17), 2 * DUMP_LINE_LEN);
+        TST_COMPARE((int)dump_size(0xfffffff0ULL, 17), 2 * DUMP_LINE_LEN + 1);
+        TST_COMPARE((int)dump_size(0xffffffe8ULL, 24), 2 * DUMP_LINE_LEN);
+        TST_COMPARE((int)dump_line_len(0x100000000ULL), DUMP_LINE_LEN + 1);
+    );
+
+    TST_CASE(
+        "dump_line",
+        TST_VERIFY(string_compare(full, "00000010  48 65 6c 6c 6f 2c 20 77  6f 72 6c 64 21 0a 01 02  "
+                                        "|Hello, world!...|\n"));
+        TST_VERIFY(string_compare(half, "abcdef12  48 65 6c 6c 6f 2c 20 77  6f                       "
+                                        "|Hello, wo       |\n"));
+        TST_VERIFY(string_compare(short_line, "00000000  78 79 7a                                          "
+                                              "|xyz             |\n"));
+    );
+}
+
+void test_process_api()
+{
+    ProcessRegion region;
+    uint64 start = 0;
+    uint64 end = 0;
+
+    TST_CASE(
+        "process_parse_region",
+        TST_VERIFY(process_parse_region("7f0000001000-7f0000003000 r-xp 00001000 08:01 1234   /usr/lib/libc.so.6\n",
+                                        &region));
+        TST_VERIFY(region.start == 0x7f0000001000ULL && region.end == 0x7f0000003000ULL);
+        TST_VERIFY(region.readable);
+        TST_VERIFY(string_compare(region.name, "/usr/lib/libc.so.6"));
+        TST_VERIFY(process_parse_region("00400000-00401000 ---p 00000000 00:00 0\n", &region));
+        TST_VERIFY(!region.readable);
+        TST_VERIFY(string_compare(region.name, ""));
+        TST_VERIFY(!process_parse_region("garbage", &region));
+    );
+
+    TST_CASE(
+        "process_parse_range",
+        TST_VERIFY(process_parse_range("1000-2fff", &start, &end));
+        TST_VERIFY(start == 0x1000 && end == 0x2fff);
+        TST_VERIFY(process_parse_range("0x10-0x20", &start, &end));
+        TST_VERIFY(start == 0x10 && end == 0x20);
+        TST_VERIFY(!process_parse_range("[heap]", &start, &end));
+        TST_VERIFY(!process_parse_range("20-10", &start, &end));
+        TST_VERIFY(!process_parse_range("10-20x", &start, &end));
+    );
+
+    // nothing is printed, but mapping must still exist
+    TST_CASE(
+        "action_process",
+        TST_COMPARE(action_process(getpid(), "[stack]", 0), EXIT_SUCCESS);
+        TST_COMPARE(action_process(getpid(), NULL, 0), EXIT_SUCCESS);
+    );
+}
+
+void test_elf_api()
+{
+    // 64 bit little endian header with 2 program headers and 5 sections
+    uint8 header64[64] = {0x7f, 'E', 'L', 'F', 2, 1, 1};
+    header64[32] = 0x40;            // phoff
+    header64[40] = 0x00;            // shoff
+    header64[41] = 0x10;
+    header64[54] = 56;              // phentsize
+    header64[56] = 2;               // phnum
+    header64[58] = 64;              // shentsize
+    header64[60] = 5;               // shnum
+    header64[62] = 4;               // shstrndx
+
+    // 32 bit big endian PT_LOAD entry
+    const uint8 segment32[32] = {0, 0, 0, 1, 0, 0, 0x10, 0, 0x08, 0x04, 0x80, 0, 0, 0, 0, 0, 0, 0, 0x02, 0};
+    ElfHeader header;
+    ElfHeader header32 = {false, true, 0, 0, 0, 0, 0, 32, 1};
+    ElfRegion segment;
+
+    TST_CASE(
+        "elf_value",
+        TST_VERIFY(elf_value((const uint8*)"\x01\x02\x03\x04", 4, false) == 0x04030201);
+        TST_VERIFY(elf_value((const uint8*)"\x01\x02\x03\x04", 4, true) == 0x01020304);
+        TST_VERIFY(elf_value((const uint8*)"\x01\x02", 2, true) == 0x0102);
+    );
+
+    TST_CASE(
+        "elf_parse_header",
+        TST_VERIFY(elf_parse_header(header64, sizeof(header64), &header));
+        TST_VERIFY(header.is64 && !header.big_endian);
+        TST_VERIFY(header.phoff == 0x40 && header.shoff == 0x1000);
+        TST_COMPARE((int)header.phnum, 2);
+        TST_COMPARE((int)header.shnum, 5);
+        TST_COMPARE((int)header.shstrndx, 4);
+        TST_VERIFY(!elf_parse_header((const uint8*)"\x7f" "ELF", 4, &header));
+        TST_VERIFY(!elf_parse_header(segment32, sizeof(segment32), &header));
+    );
+
+    elf_parse_segment(&header32, segment32, 3, &segment);
+
+    TST_CASE(
+        "elf_parse_segment",
+        TST_VERIFY(segment.type == PT_LOAD);
+        TST_VERIFY(segment.offset == 0x1000 && segment.address == 0x08048000 && segment.size == 0x200);
+        TST_VERIFY(string_compare(segment.name, "PT_LOAD[3]"));
+        TST_VERIFY(elf_name_match(&segment, true, "PT_LOAD"));
+        TST_VERIFY(elf_name_match(&segment, true, "PT_LOAD[3]"));
+        TST_VERIFY(!elf_name_match(&segment, true, "PT_LOAD[0]"));
+        TST_VERIFY(!elf_name_match(&segment, false, "PT_LOAD"));
+    );
+}
+
+void test_cache_api()
+{
+    const char* argv[] = {"proj1", "-t", "u32le", "-s", "16", "-j", "4", "-t", "u16le"};
+    int64 params[FLAGS_COUNT];
+    char key[CACHE_KEY_SIZE];
+    char same[CACHE_KEY_SIZE];
+    char other[CACHE_KEY_SIZE];
+    char input[CACHE_KEY_SIZE];
+
+    for(int i = 0; i < FLAGS_COUNT; ++i)
+        params[i] = 0;
+
+    params[flag_index(SKIP)] = 16;
+    params[flag_index(TYPED)] = 2;
+    cache_key(SKIP | TYPED, params, argv, 1, key);
+
+    // -j does not change output, string parameter is compared by content
+    params[flag_index(THREADS)] = 4;
+    params[flag_index(TYPED)] = 2;
+    cache_key(SKIP | TYPED | THREADS, params, argv, 1, same);
+
+    params[flag_index(TYPED)] = 8;
+    cache_key(SKIP | TYPED, params, argv, 1, other);
+    cache_key(SKIP | TYPED, params, argv, 2, input);
+
+    TST_CASE(
+        "cache_key",
+        TST_COMPARE((int)string_len(key), CACHE_KEY_SIZE - 1);
+        TST_VERIFY(string_compare(key, same));
+        TST_VERIFY(!string_compare(key, other));
+        TST_VERIFY(!string_compare(other, input));
+        TST_VERIFY(key[16] == '-');
+    );
+
+    char dir[] = "/tmp/proj1-cache-XXXXXX";
+    IoContext* io = io_context();
+    IoContext quiet = *io;
+    Cache cache = {dir, "", "", -1, false, {0}, &quiet};
+    struct stat st;
+    int status = EXIT_FAILURE;
+    const mode_t mask = umask(022);
+
+    // recorded output is also written to previous context
+    quiet.out = fopen("/dev/null", "w");
+    quiet.out_fd = -1;
+
+    TST_CASE(
+        "cache limit",
+        TST_VERIFY(mkdtemp(dir) != NULL);
+        snprintf(cache.path, PATH_MAX, "%s/%s", dir, key);
+        TST_VERIFY(cache_begin(&cache));
+        io_write("0123456789", 10);
+        cache_end(&cache, true, 1 << 20);
+        TST_VERIFY(stat(cache.path, &st) == 0);
+        TST_COMPARE((int)(st.st_mode & 0777), 0644);
+        TST_VERIFY(!cache_serve(&cache, &status, 9));
+        TST_VERIFY(stat(cache.path, &st) != 0);
+        TST_VERIFY(rmdir(dir) == 0);
     );
 
+    io_set_context(io);
+    fclose(quiet.out);
+    umask(mask);
 }
 #endif
@@ -4,3 +4,5 @@ CONFIG -= app_bundle
 CONFIG -= qt
 
 SOURCES += main.c
+
+LIBS += -pthread